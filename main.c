@@ -10,10 +10,15 @@ Author: Eldin Nokic
 -------------------------------------------------*/
 
 
+#define _POSIX_C_SOURCE 200809L // open_memstream, sysconf
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /*
 Struct: Org
@@ -23,14 +28,188 @@ Fields:
     name - fixed size name
     prey - dynamic array of indices of organisms this org eats
     numprey - number of valid entries in prey[]
+    packed - prey indices in compact form (see packOrg), used instead
+             of prey[] while prey is NULL
+    lastPrey - largest prey index, only kept up to date while packed
 */
 
 typedef struct Org_struct {
     char name[20];
     int* prey; //dynamic array of indices  
     int numPrey;
+    int lastPrey;
+    unsigned char* packed; //sorted prey indices, delta + varint encoded
 } Org;
 
+/*
+Struct: PreyIter
+Purpose:
+    Walks an organism's prey indices whether they are held in prey[]
+    or in packed form.
+Fields:
+    org - organism being walked
+    pos - number of prey already returned
+    byte - read offset into org->packed
+    last - last prey index decoded from org->packed
+*/
+typedef struct PreyIter_struct {
+    Org* org;
+    int pos;
+    int byte;
+    int last;
+} PreyIter;
+
+/*
+Function: preyIterStart
+Purpose:
+    Position an iterator before the first prey of an organism
+Parameters:
+    it - iterator to set up
+    org - organism to walk
+Returns:
+    void
+*/
+static inline void preyIterStart(PreyIter* it, Org* org) {
+    it->org = org;
+    it->pos = 0;
+    it->byte = 0;
+    it->last = 0;
+}
+
+/*
+Function: preyIterNext
+Purpose:
+    Fetch the next prey index. Packed lists store the first index and
+    then the gap to each following one, 7 bits per byte with the high
+    bit set on every byte but the last of a number.
+Parameters:
+    it - iterator
+    pPreyInd - receives the prey index
+Returns:
+    true if a prey index was fetched, false at the end of the list
+*/
+static inline bool preyIterNext(PreyIter* it, int* pPreyInd) {
+    Org* org = it->org;
+    if (it->pos >= org->numPrey) {
+        return false;
+    }
+    if (org->prey != NULL) {
+        *pPreyInd = org->prey[it->pos++];
+        return true;
+    }
+
+    unsigned int value = 0;
+    int shift = 0;
+    unsigned char b;
+    do {
+        b = org->packed[it->byte++];
+        value |= (unsigned int)(b & 0x7F) << shift;
+        shift += 7;
+    } while (b & 0x80);
+
+    it->last = (it->pos == 0) ? (int)value : it->last + (int)value;
+    it->pos++;
+    *pPreyInd = it->last;
+    return true;
+}
+
+/*
+Function: compareInts
+Purpose:
+    qsort comparator for ascending ints
+Parameters:
+    a, b - pointers to int
+Returns:
+    negative, zero or positive as for qsort
+*/
+int compareInts(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/*
+Function: packOrg
+Purpose:
+    Replace an organism's prey[] with the packed form read by
+    preyIterNext. The list is sorted first so the gaps stay small;
+    most take a single byte instead of four.
+Parameters:
+    org - organism to pack, left as is if already packed or without prey
+Returns:
+    void
+*/
+void packOrg(Org* org) {
+    if (org->prey == NULL) {
+        return;
+    }
+
+    int n = org->numPrey;
+    qsort(org->prey, n, sizeof(int), compareInts);
+    org->lastPrey = org->prey[n - 1];
+
+    int numBytes = 0;
+    for (int j = 0; j < n; j++) {
+        unsigned int gap = (j == 0) ? (unsigned int)org->prey[0] : (unsigned int)(org->prey[j] - org->prey[j - 1]);
+        do {
+            numBytes++;
+            gap >>= 7;
+        } while (gap != 0);
+    }
+
+    unsigned char* packed = (unsigned char*)malloc(numBytes);
+    if (packed == NULL) {
+        return;
+    }
+
+    int c = 0;
+    for (int j = 0; j < n; j++) {
+        unsigned int gap = (j == 0) ? (unsigned int)org->prey[0] : (unsigned int)(org->prey[j] - org->prey[j - 1]);
+        while (gap >= 0x80) {
+            packed[c++] = (unsigned char)(gap & 0x7F) | 0x80;
+            gap >>= 7;
+        }
+        packed[c++] = (unsigned char)gap;
+    }
+
+    free(org->prey);
+    org->prey = NULL;
+    org->packed = packed;
+}
+
+/*
+Function: unpackOrg
+Purpose:
+    Turn a packed organism back into a plain prey[] so it can be
+    modified. Prey come back in index order.
+Parameters:
+    org - organism to unpack, left as is if not packed
+Returns:
+    void
+*/
+void unpackOrg(Org* org) {
+    if (org->packed == NULL) {
+        return;
+    }
+
+    int* prey = (int*)malloc(sizeof(int) * org->numPrey);
+    if (prey == NULL) {
+        return;
+    }
+
+    PreyIter it;
+    int preyInd;
+    int c = 0;
+    preyIterStart(&it, org);
+    while (preyIterNext(&it, &preyInd)) {
+        prey[c++] = preyInd;
+    }
+
+    free(org->packed);
+    org->packed = NULL;
+    org->prey = prey;
+}
+
 
 /*
 Function: addOrgToWeb
@@ -56,6 +235,8 @@ void addOrgToWeb(Org** pWeb, int* pNumOrgs, char* newOrgName) {
     strcpy(newArray[oldSize].name, newOrgName);
     newArray[oldSize].prey = NULL;
     newArray[oldSize].numPrey = 0;
+    newArray[oldSize].lastPrey = 0;
+    newArray[oldSize].packed = NULL;
 
     if (*pWeb != NULL) {
         free(*pWeb);
@@ -73,22 +254,34 @@ Parameters:
     numOrgs - number of organisms
     predInd - predator index
     preyInd - prey index
+    out - stream for the message about a rejected relation
 Returns: 
     true if relation is added, falee if its invalid or a duplicate
 */
-bool addRelationToWeb(Org* web, int numOrgs, int predInd, int preyInd) {
+bool addRelationToWeb(Org* web, int numOrgs, int predInd, int preyInd, FILE* out) {
     if ((predInd < 0) || (predInd > numOrgs - 1) || (preyInd < 0) || (preyInd > numOrgs - 1) || (predInd == preyInd)) {
-        printf("Invalid predator and/or prey index. No relation added to the food web.\n");
+        fprintf(out, "Invalid predator and/or prey index. No relation added to the food web.\n");
         return false;
     }
     
     Org* pred = &web[predInd];
 
-    for (int i = 0; i < pred->numPrey; i++) {
-        if (pred->prey[i] == preyInd) {
-            printf("Duplicate predator/prey relation. No relation added to the food web.\n");
+    PreyIter it;
+    int ind;
+    preyIterStart(&it, pred);
+    while (preyIterNext(&it, &ind)) {
+        if (ind == preyInd) {
+            fprintf(out, "Duplicate predator/prey relation. No relation added to the food web.\n");
             return false;
         }
+        if (pred->packed != NULL && ind > preyInd) { // Packed lists are sorted, the rest are all larger
+            break;
+        }
+    }
+
+    unpackOrg(pred); // Only once the relation is known to go in, packed lists stay packed otherwise
+    if (pred->prey == NULL && pred->numPrey > 0) { // Could not allocate the plain list, still packed
+        return false;
     }
 
     int n = pred->numPrey;
@@ -110,6 +303,86 @@ bool addRelationToWeb(Org* web, int numOrgs, int predInd, int preyInd) {
 
 }
 
+/*
+Function: renumberPrey
+Purpose:
+    Update one organism's prey[] after the organism at index was
+    removed from the web: drop index and shift larger indices down
+Parameters:
+    org - organism whose plain prey[] is updated
+    index - extinction index
+Returns:
+    void
+*/
+void renumberPrey(Org* org, int index) {
+    int oldCount = org->numPrey;
+    int* oldArr = org->prey;
+
+    if (!oldCount || oldArr == NULL) {
+        return;
+    }
+
+    bool extinct = false;
+    bool greater = false;
+
+    for (int j = 0; j < oldCount; j++) {
+        if (oldArr[j] == index) {
+            extinct = true;
+        }
+        else if (oldArr[j] > index) {
+            greater = true;
+        }
+    }
+
+    if (!extinct && greater) {
+        for (int j = 0; j < oldCount; j++){
+            if (oldArr[j] > index){
+                --oldArr[j];
+            }
+        }
+        return;
+    }
+
+    if (!extinct && !greater) {
+        return;
+    }
+
+    int newCount;
+    if (extinct) {
+        newCount = oldCount - 1;
+    }
+    else {
+        newCount = oldCount;
+    }
+
+    if (newCount == 0) {
+        free(oldArr);
+        org->prey = NULL;
+        org->numPrey = 0;
+        return;
+    }
+
+    int* newArr = (int*)malloc(sizeof(int)*newCount);
+    if (newArr == NULL) {
+        return;
+    }
+
+    int c = 0;
+    for (int j = 0; j < oldCount; j++) {
+        int ind = oldArr[j];
+        if (ind == index) {
+            continue;
+        }
+        if (ind > index) {
+            ind -= 1;
+        }
+        newArr[c++] = ind;
+    }
+    free(oldArr);
+    org->prey = newArr;
+    org->numPrey = newCount;
+}
+
 /*
 Function: removeOrgFromWeb
 Purpose: 
@@ -140,6 +413,7 @@ bool removeOrgFromWeb(Org** pWeb, int* pNumOrgs, int index) {
         if (web[0].prey != NULL) {
             free(web[0].prey);
         }
+        free(web[0].packed);
         free(web);
         *pWeb = NULL;
         *pNumOrgs = 0;
@@ -151,6 +425,7 @@ bool removeOrgFromWeb(Org** pWeb, int* pNumOrgs, int index) {
             web[index].prey = NULL;
             web[index].numPrey = 0;
         }
+    free(web[index].packed);
     
     Org* newWeb = (Org*)malloc(sizeof(Org) * (n-1));
     if (newWeb == NULL) {
@@ -172,72 +447,14 @@ bool removeOrgFromWeb(Org** pWeb, int* pNumOrgs, int index) {
     n = *pNumOrgs;
 
     for (int i = 0; i < n; i++) {
-        int oldCount = web[i].numPrey;
-        int* oldArr = web[i].prey;
-
-        if (!oldCount || oldArr == NULL) {
-            continue;
-        }
-
-        bool extinct = false;
-        bool greater = false;
-
-        for (int j = 0; j < oldCount; j++) {
-            if (oldArr[j] == index) {
-                extinct = true;
-            }
-            else if (oldArr[j] > index) {
-                greater = true;
-            }
-        }
-
-        if (!extinct && greater) {
-            for (int j = 0; j < oldCount; j++){
-                if (oldArr[j] > index){
-                    --oldArr[j];
-                }
-            }
-            continue;
-        }
-
-        if (!extinct && !greater) {
-            continue;
+        if (web[i].packed == NULL) {
+            renumberPrey(&web[i], index);
         }
-
-        int newCount;
-        if (extinct) {
-            newCount = oldCount - 1;
-        }
-        else {
-            newCount = oldCount;
-        }
-
-        if (newCount == 0) {
-            free(oldArr);
-            web[i].prey = NULL;
-            web[i].numPrey = 0;
-            continue;
-        }
-
-        int* newArr = (int*)malloc(sizeof(int)*newCount);
-        if (newArr == NULL) {
-            continue;
-        }
-
-        int c = 0;
-        for (int j = 0; j < oldCount; j++) {
-            int ind = oldArr[j];
-            if (ind == index) {
-                continue;
-            }
-            if (ind > index) {
-                ind -= 1;
-            }
-            newArr[c++] = ind;
+        else if (web[i].lastPrey >= index) { // Packed lists are sorted, smaller prey keep their indices
+            unpackOrg(&web[i]);
+            renumberPrey(&web[i], index);
+            packOrg(&web[i]);
         }
-        free(oldArr);
-        web[i].prey = newArr;
-        web[i].numPrey = newCount;
     }
     return true;
 }
@@ -260,6 +477,7 @@ void freeWeb(Org* web, int numOrgs) {
         if (web[i].prey != NULL) {
             free(web[i].prey);
         }
+        free(web[i].packed);
     }
     free(web);
 }
@@ -269,26 +487,28 @@ Function: printWeb
 Purpose: 
     Human readable printout of the food web
 Parameters:
-    web, numOrgs
+    web, numOrgs, out - stream to print to
 Returns: 
     void
 */
-void printWeb(Org* web, int numOrgs) {
+void printWeb(Org* web, int numOrgs, FILE* out) {
     for (int i = 0; i < numOrgs; i++) {
-        printf("  (%d) %s", i, web[i].name);
+        fprintf(out, "  (%d) %s", i, web[i].name);
         if (web[i].numPrey > 0) {
-            printf(" eats ");
-            for (int j = 0; j < web[i].numPrey; j++) {
-                int preyInd = web[i].prey[j];
-                printf("%s", web[preyInd].name);
-                if (j < web[i].numPrey - 1) {
-                    printf(", ");
+            fprintf(out, " eats ");
+            PreyIter it;
+            int preyInd;
+            preyIterStart(&it, &web[i]);
+            while (preyIterNext(&it, &preyInd)) {
+                fprintf(out, "%s", web[preyInd].name);
+                if (it.pos < web[i].numPrey) {
+                    fprintf(out, ", ");
                 }
             }
         }
-        printf("\n");
+        fprintf(out, "\n");
     }
-    printf("\n");
+    fprintf(out, "\n");
 }
 
 /*
@@ -309,8 +529,10 @@ int* eatenByCounts(Org* web, int numOrgs) {
     }
 
     for (int i = 0; i < numOrgs; i++) {
-        for (int j = 0; j < web[i].numPrey; j++) {
-            int preyInd = web[i].prey[j];
+        PreyIter it;
+        int preyInd;
+        preyIterStart(&it, &web[i]);
+        while (preyIterNext(&it, &preyInd)) {
             eatenBy[preyInd]++;
         }
     }
@@ -341,8 +563,10 @@ int* calculateHeights(Org* web, int numOrgs) {
             int newHeight = 0;
             if (web[i].numPrey > 0) {
                 int maxPreyHeight = 0;
-                for (int j = 0; j < web[i].numPrey; j++) {
-                    int preyInd = web[i].prey[j];
+                PreyIter it;
+                int preyInd;
+                preyIterStart(&it, &web[i]);
+                while (preyIterNext(&it, &preyInd)) {
                     if (height[preyInd] > maxPreyHeight) {
                         maxPreyHeight = height[preyInd];
                     }
@@ -363,51 +587,50 @@ Function: printHeights
 Purpose:
     Print each organism's height 
 Parameters:
-    web, numOrgs, height
+    web, numOrgs, height, out - stream to print to
 Returns: 
     void
 */
-void printHeights(Org* web, int numOrgs, int* height) {
+void printHeights(Org* web, int numOrgs, int* height, FILE* out) {
     for (int i = 0; i < numOrgs; i++) {
-        printf("  %s: %d\n", web[i].name, height[i]);
+        fprintf(out, "  %s: %d\n", web[i].name, height[i]);
     }
 }
 
+typedef enum { PRODUCER, HERBIVORE, OMNIVORE, CARNIVORE } VoreType; // Also the order they are printed in
+
 /*
-Function: printVoreTypes
-Purpose: 
-    Classify and print producers, Herbivores, Omnivores, Carnivores
+Function: classifyVores
+Purpose:
+    Classify every organism as a producer (eats nothing), herbivore
+    (eats only producers), omnivore (eats producers and consumers)
+    or carnivore (eats only consumers)
 Parameters:
     web, numOrgs
-Returns: 
-    void
+Returns:
+    an int array of size numOrgs holding VoreType values, caller frees it
 */
-void printVoreTypes(Org* web, int numOrgs) {
-    int* producer = (int*)malloc(sizeof(int)*numOrgs);
+int* classifyVores(Org* web, int numOrgs) {
+    int* vore = (int*)malloc(sizeof(int)*numOrgs);
     for (int i = 0; i < numOrgs; i++) {
         if (web[i].numPrey == 0) {
-            producer[i] = 1;
+            vore[i] = PRODUCER;
         }
         else {
-            producer[i] = 0;
-        }
-    }
-    printf("  Producers:\n");
-    for (int i = 0; i < numOrgs; i++) {
-        if (producer[i]) {
-            printf("    %s\n", web[i].name);
+            vore[i] = CARNIVORE; // placeholder until the second pass, anything but PRODUCER
         }
     }
 
-    printf("  Herbivores:\n");
     for (int i = 0; i < numOrgs; i++) {
-        if (producer[i]) {
+        if (vore[i] == PRODUCER) {
             continue;
         }
         int eatsP = 0, eatsNP = 0;
-        for (int j = 0; j < web[i].numPrey; j++) {
-            int preyInd = web[i].prey[j];
-            if (producer[preyInd]) {
+        PreyIter it;
+        int preyInd;
+        preyIterStart(&it, &web[i]);
+        while (preyIterNext(&it, &preyInd)) {
+            if (web[preyInd].numPrey == 0) {
                 eatsP = 1;
             }
             else {
@@ -415,91 +638,102 @@ void printVoreTypes(Org* web, int numOrgs) {
             }
         }
         if (eatsP && !eatsNP) {
-            printf("    %s\n", web[i].name);
-        }
-    }
-
-    printf("  Omnivores:\n"); 
-    for (int i = 0; i < numOrgs; i++) {
-        if (producer[i]) {
-            continue;
+            vore[i] = HERBIVORE;
         }
-        int eatsP = 0, eatsNP = 0;
-        for (int j = 0; j < web[i].numPrey; j++) {
-            int preyInd = web[i].prey[j];
-            if (producer[preyInd]) {
-                eatsP = 1;
-            }
-            else {
-                eatsNP = 1;
-            }
+        else if (eatsP && eatsNP) {
+            vore[i] = OMNIVORE;
         }
-        if (eatsP && eatsNP) {
-            printf("    %s\n", web[i].name);
+        else {
+            vore[i] = CARNIVORE;
         }
     }
+    return vore;
+}
 
-    printf("  Carnivores:\n");
-    for (int i = 0; i < numOrgs; i++) {
-        if (producer[i]) {
-            continue;
-        }
-        int eatsP = 0, eatsNP = 0;
-        for (int j = 0; j < web[i].numPrey; j++) {
-            int preyInd = web[i].prey[j];
-            if (producer[preyInd]) {
-                eatsP = 1;
-            }
-            else {
-                eatsNP = 1;
+/*
+Function: printVoreClasses
+Purpose:
+    Print organisms grouped by an already computed vore classification
+Parameters:
+    web, numOrgs, vore (from classifyVores), out - stream to print to
+Returns:
+    void
+*/
+void printVoreClasses(Org* web, int numOrgs, int* vore, FILE* out) {
+    char* titles[] = { "  Producers:\n", "  Herbivores:\n", "  Omnivores:\n", "  Carnivores:\n" };
+
+    for (int type = PRODUCER; type <= CARNIVORE; type++) {
+        fprintf(out, "%s", titles[type]);
+        for (int i = 0; i < numOrgs; i++) {
+            if (vore[i] == type) {
+                fprintf(out, "    %s\n", web[i].name);
             }
         }
-        if (!eatsP && eatsNP) {
-            printf("    %s\n", web[i].name);
-        }
     }
-    printf("\n");
-    free(producer);
+    fprintf(out, "\n");
 }
 
 /*
-Function: displayAll
+Function: printVoreTypes
 Purpose: 
-    Print all analyses (web, apex, producers, flexible eaters, 
-    tastiest food, heights, and vore types.) Adds UPDATES prefix when modified = true
+    Classify and print producers, Herbivores, Omnivores, Carnivores
 Parameters:
-    web, numOrgs, modified
+    web, numOrgs, out - stream to print to
 Returns: 
     void
 */
-void displayAll(Org* web, int numOrgs, bool modified) {
-
-    if (modified) printf("UPDATED ");
-    printf("Food Web Predators & Prey:\n");
-    printWeb(web,numOrgs); 
-
-    int* eatenBy = eatenByCounts(web, numOrgs);
+void printVoreTypes(Org* web, int numOrgs, FILE* out) {
+    int* vore = classifyVores(web, numOrgs);
+    printVoreClasses(web, numOrgs, vore, out);
+    free(vore);
+}
 
-    if (modified) printf("UPDATED ");
-    printf("Apex Predators:\n");
+/*
+Function: printApexPredators
+Purpose:
+    Print every organism that nothing else eats
+Parameters:
+    web, numOrgs, eatenBy (from eatenByCounts), out - stream to print to
+Returns:
+    void
+*/
+void printApexPredators(Org* web, int numOrgs, int* eatenBy, FILE* out) {
     for (int i = 0; i < numOrgs; i++) {
         if (eatenBy[i] == 0) {
-            printf("  %s\n", web[i].name);
+            fprintf(out, "  %s\n", web[i].name);
         }
     }
-    printf("\n");
+    fprintf(out, "\n");
+}
 
-    if (modified) printf("UPDATED ");
-    printf("Producers:\n");
+/*
+Function: printProducers
+Purpose:
+    Print every organism that eats nothing
+Parameters:
+    web, numOrgs, out - stream to print to
+Returns:
+    void
+*/
+void printProducers(Org* web, int numOrgs, FILE* out) {
     for (int i = 0; i < numOrgs; i++) {
         if (web[i].numPrey == 0) {
-            printf("  %s\n", web[i].name);
+            fprintf(out, "  %s\n", web[i].name);
         }
     }
-    printf("\n");
+    fprintf(out, "\n");
+}
 
-    if (modified) printf("UPDATED ");
-    printf("Most Flexible Eaters:\n");
+/*
+Function: printMostFlexibleEaters
+Purpose:
+    Print every organism tied for the most prey
+Parameters:
+    web, numOrgs, out - stream to print to
+Returns:
+    void
+*/
+void printMostFlexibleEaters(Org* web, int numOrgs, FILE* out) {
     int maxPrey = 0;
     for (int i = 0; i < numOrgs; i++) {
         if (web[i].numPrey > maxPrey) {
@@ -508,13 +742,22 @@ void displayAll(Org* web, int numOrgs, bool modified) {
     }
     for (int i = 0; i < numOrgs; i++) {
         if (web[i].numPrey == maxPrey) {
-            printf("  %s\n", web[i].name);
+            fprintf(out, "  %s\n", web[i].name);
         }
     }
-    printf("\n");
+    fprintf(out, "\n");
+}
 
-    if (modified) printf("UPDATED ");
-    printf("Tastiest Food:\n");
+/*
+Function: printTastiestFood
+Purpose:
+    Print every organism tied for the most predators
+Parameters:
+    web, numOrgs, eatenBy (from eatenByCounts), out - stream to print to
+Returns:
+    void
+*/
+void printTastiestFood(Org* web, int numOrgs, int* eatenBy, FILE* out) {
     int maxEaten = 0;
     for (int i = 0; i < numOrgs; i++) {
         if (eatenBy[i] > maxEaten) {
@@ -523,88 +766,1519 @@ void displayAll(Org* web, int numOrgs, bool modified) {
     }
     for (int i = 0; i < numOrgs; i++) {
         if (eatenBy[i] == maxEaten) {
-            printf("  %s\n", web[i].name);
+            fprintf(out, "  %s\n", web[i].name);
         }
     }
-    printf("\n");
-    free(eatenBy);
-
-    if (modified) printf("UPDATED ");
-    printf("Food Web Heights:\n");
-    int* heights = calculateHeights(web, numOrgs);
-    printHeights(web, numOrgs, heights);
-    free(heights);
-    printf("\n");
-
-    if (modified) printf("UPDATED ");
-    printf("Vore Types:\n");
-    printVoreTypes(web, numOrgs);
+    fprintf(out, "\n");
 }
 
 /*
-Funciton: setModes
+Function: displayAll
 Purpose: 
-    parse -b, -d, -q flags from argv; each at most once
+    Print all analyses (web, apex, producers, flexible eaters, 
+    tastiest food, heights, and vore types.) Adds UPDATES prefix when modified = true
 Parameters:
-    argc, argv, pBasicMode, pDebugMode, pQuietMode
+    web, numOrgs, modified, out - stream to print to
 Returns: 
-    true on success, false if any invalid/duplicate flag.
+    void
 */
-bool setModes(int argc, char* argv[], bool* pBasicMode, bool* pDebugMode, bool* pQuietMode) {
+void displayAll(Org* web, int numOrgs, bool modified, FILE* out) {
 
-    int bCount = 0, dCount = 0, qCount = 0;
+    if (modified) fprintf(out, "UPDATED ");
+    fprintf(out, "Food Web Predators & Prey:\n");
+    printWeb(web,numOrgs,out); 
 
-    *pDebugMode = false;
-    *pQuietMode = false;
-    *pBasicMode = false;
+    int* eatenBy = eatenByCounts(web, numOrgs);
 
-    for (int i = 1; i < argc; i++) {
+    if (modified) fprintf(out, "UPDATED ");
+    fprintf(out, "Apex Predators:\n");
+    printApexPredators(web, numOrgs, eatenBy, out);
 
-        char* s = argv[i];
+    if (modified) fprintf(out, "UPDATED ");
+    fprintf(out, "Producers:\n");
+    printProducers(web, numOrgs, out);
 
-        if (strncmp(s,"-d",2) == 0) {
-            if (dCount == 1) {
-                return false;
-            }
-            else {
-                dCount++;
-                *pDebugMode = true;
-            }
-        }
-        else if (strncmp(s,"-b",2) == 0) {
+    if (modified) fprintf(out, "UPDATED ");
+    fprintf(out, "Most Flexible Eaters:\n");
+    printMostFlexibleEaters(web, numOrgs, out);
+
+    if (modified) fprintf(out, "UPDATED ");
+    fprintf(out, "Tastiest Food:\n");
+    printTastiestFood(web, numOrgs, eatenBy, out);
+    free(eatenBy);
+
+    if (modified) fprintf(out, "UPDATED ");
+    fprintf(out, "Food Web Heights:\n");
+    int* heights = calculateHeights(web, numOrgs);
+    printHeights(web, numOrgs, heights, out);
+    free(heights);
+    fprintf(out, "\n");
+
+    if (modified) fprintf(out, "UPDATED ");
+    fprintf(out, "Vore Types:\n");
+    printVoreTypes(web, numOrgs, out);
+}
+
+/*
+Struct: OrgReport
+Purpose:
+    What a report showed for one organism.
+Fields:
+    name - organism name
+    numPrey - number of prey
+    eatenBy - number of predators
+    height - food web height
+    vore - VoreType
+*/
+typedef struct OrgReport_struct {
+    char name[20];
+    int numPrey;
+    int eatenBy;
+    int height;
+    int vore;
+} OrgReport;
+
+/*
+Struct: ReportState
+Purpose:
+    What the last report showed for each organism, kept so the next
+    report can print only what changed. Entries line up with web
+    indices as long as every extinction is passed to reportOrgRemoved.
+Fields:
+    orgs - one entry per organism in the last report
+    numOrgs - number of entries in orgs
+    removed - entries of organisms gone extinct since the last report
+    numRemoved - number of entries in removed
+*/
+typedef struct ReportState_struct {
+    OrgReport* orgs;
+    int numOrgs;
+    OrgReport* removed;
+    int numRemoved;
+} ReportState;
+
+/*
+Function: initReportState
+Purpose:
+    Start with nothing reported yet
+Parameters:
+    state - state to set up
+Returns:
+    void
+*/
+void initReportState(ReportState* state) {
+    state->orgs = NULL;
+    state->numOrgs = 0;
+    state->removed = NULL;
+    state->numRemoved = 0;
+}
+
+/*
+Function: freeReportState
+Purpose:
+    Free the arrays held by a report state
+Parameters:
+    state
+Returns:
+    void
+*/
+void freeReportState(ReportState* state) {
+    free(state->orgs);
+    free(state->removed);
+    initReportState(state);
+}
+
+/*
+Function: summarizeWeb
+Purpose:
+    Compute everything a delta report compares for every organism
+Parameters:
+    web, numOrgs
+Returns:
+    an OrgReport array of size numOrgs, caller frees it
+*/
+OrgReport* summarizeWeb(Org* web, int numOrgs) {
+    OrgReport* orgs = (OrgReport*)malloc(sizeof(OrgReport) * (numOrgs + 1));
+    int* eatenBy = eatenByCounts(web, numOrgs);
+    int* heights = calculateHeights(web, numOrgs);
+    int* vore = classifyVores(web, numOrgs);
+
+    for (int i = 0; i < numOrgs; i++) {
+        strcpy(orgs[i].name, web[i].name);
+        orgs[i].numPrey = web[i].numPrey;
+        orgs[i].eatenBy = eatenBy[i];
+        orgs[i].height = heights[i];
+        orgs[i].vore = vore[i];
+    }
+
+    free(eatenBy);
+    free(heights);
+    free(vore);
+    return orgs;
+}
+
+/*
+Function: recordReport
+Purpose:
+    Remember the web as it is now as the last reported web
+Parameters:
+    state, web, numOrgs
+Returns:
+    void
+*/
+void recordReport(ReportState* state, Org* web, int numOrgs) {
+    freeReportState(state);
+    state->orgs = summarizeWeb(web, numOrgs);
+    state->numOrgs = numOrgs;
+}
+
+/*
+Function: reportOrgRemoved
+Purpose:
+    Keep a report state lined up with the web after removeOrgFromWeb.
+    An organism added and removed between two reports is never shown.
+Parameters:
+    state - report state
+    index - index that was just removed from the web
+Returns:
+    void
+*/
+void reportOrgRemoved(ReportState* state, int index) {
+    if (index < 0 || index >= state->numOrgs) {
+        return;
+    }
+
+    OrgReport* newRemoved = (OrgReport*)malloc(sizeof(OrgReport) * (state->numRemoved + 1));
+    for (int i = 0; i < state->numRemoved; i++) {
+        newRemoved[i] = state->removed[i];
+    }
+    newRemoved[state->numRemoved] = state->orgs[index];
+    free(state->removed);
+    state->removed = newRemoved;
+    state->numRemoved++;
+
+    for (int i = index + 1; i < state->numOrgs; i++) {
+        state->orgs[i - 1] = state->orgs[i];
+    }
+    state->numOrgs--;
+}
+
+/*
+Function: orgReportChanged
+Purpose:
+    Tell whether any reported field differs between two reports of
+    the same organism
+Parameters:
+    old - entry from the last report
+    now - entry for the web as it is now
+Returns:
+    true if prey count, predator count, height or vore type changed
+*/
+bool orgReportChanged(OrgReport* old, OrgReport* now) {
+    return now->numPrey != old->numPrey || now->eatenBy != old->eatenBy
+           || now->height != old->height || now->vore != old->vore;
+}
+
+/*
+Function: printJsonString
+Purpose:
+    Print a C string as a quoted JSON string
+Parameters:
+    str, out - stream to print to
+Returns:
+    void
+*/
+void printJsonString(char* str, FILE* out) {
+    fputc('"', out);
+    for (char* c = str; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        }
+        else if ((unsigned char)*c < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned char)*c);
+        }
+        else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+/*
+Function: displayDelta
+Purpose:
+    Print only what changed since the last report: organisms added,
+    organisms removed, and organisms whose prey count, predator count,
+    height or vore type changed, plus summary counts. Then remember
+    the web as the last reported web.
+    Text lines start with + (added), - (removed) or ~ (changed, with
+    old -> new for every field that changed). JSON is one object:
+    {"organisms":N,"relations":N,"added":[...],"removed":[...],"changed":[...]}
+    where a changed entry holds the new values and a "was" object with
+    the old value of every field that changed.
+Parameters:
+    web, numOrgs, state - last report, updated,
+    json - print JSON instead of text, out - stream to print to
+Returns:
+    void
+*/
+void displayDelta(Org* web, int numOrgs, ReportState* state, bool json, FILE* out) {
+
+    char* voreNames[] = { "Producer", "Herbivore", "Omnivore", "Carnivore" };
+    char* voreKeys[] = { "producer", "herbivore", "omnivore", "carnivore" };
+
+    OrgReport* now = summarizeWeb(web, numOrgs);
+    OrgReport* old = state->orgs;
+    int numOld = state->numOrgs;
+
+    int numRelations = 0;
+    int numChanged = 0;
+    for (int i = 0; i < numOrgs; i++) {
+        numRelations += now[i].numPrey;
+        if (i < numOld && orgReportChanged(&old[i], &now[i])) {
+            numChanged++;
+        }
+    }
+    int numAdded = (numOrgs > numOld) ? numOrgs - numOld : 0;
+
+    if (json) {
+        fprintf(out, "{\"organisms\":%d,\"relations\":%d,\"added\":[", numOrgs, numRelations);
+        for (int i = numOld; i < numOrgs; i++) {
+            fprintf(out, "%s{\"index\":%d,\"name\":", (i > numOld) ? "," : "", i);
+            printJsonString(now[i].name, out);
+            fprintf(out, ",\"prey\":%d,\"predators\":%d,\"height\":%d,\"vore\":\"%s\"}",
+                    now[i].numPrey, now[i].eatenBy, now[i].height, voreKeys[now[i].vore]);
+        }
+        fprintf(out, "],\"removed\":[");
+        for (int i = 0; i < state->numRemoved; i++) {
+            if (i > 0) fputc(',', out);
+            printJsonString(state->removed[i].name, out);
+        }
+        fprintf(out, "],\"changed\":[");
+        bool first = true;
+        for (int i = 0; i < numOrgs && i < numOld; i++) {
+            if (!orgReportChanged(&old[i], &now[i])) {
+                continue;
+            }
+            fprintf(out, "%s{\"index\":%d,\"name\":", first ? "" : ",", i);
+            printJsonString(now[i].name, out);
+            fprintf(out, ",\"prey\":%d,\"predators\":%d,\"height\":%d,\"vore\":\"%s\",\"was\":{",
+                    now[i].numPrey, now[i].eatenBy, now[i].height, voreKeys[now[i].vore]);
+            char* sep = "";
+            if (now[i].numPrey != old[i].numPrey) {
+                fprintf(out, "%s\"prey\":%d", sep, old[i].numPrey);
+                sep = ",";
+            }
+            if (now[i].eatenBy != old[i].eatenBy) {
+                fprintf(out, "%s\"predators\":%d", sep, old[i].eatenBy);
+                sep = ",";
+            }
+            if (now[i].height != old[i].height) {
+                fprintf(out, "%s\"height\":%d", sep, old[i].height);
+                sep = ",";
+            }
+            if (now[i].vore != old[i].vore) {
+                fprintf(out, "%s\"vore\":\"%s\"", sep, voreKeys[old[i].vore]);
+            }
+            fprintf(out, "}}");
+            first = false;
+        }
+        fprintf(out, "]}\n");
+    }
+    else {
+        fprintf(out, "UPDATED Food Web Changes:\n");
+        fprintf(out, "  Organisms: %d (%d added, %d removed)\n", numOrgs, numAdded, state->numRemoved);
+        fprintf(out, "  Relations: %d\n", numRelations);
+        fprintf(out, "  Changed: %d\n", numChanged);
+        for (int i = numOld; i < numOrgs; i++) {
+            fprintf(out, "  + (%d) %s: prey %d, predators %d, height %d, %s\n", i, now[i].name,
+                    now[i].numPrey, now[i].eatenBy, now[i].height, voreNames[now[i].vore]);
+        }
+        for (int i = 0; i < state->numRemoved; i++) {
+            fprintf(out, "  - %s\n", state->removed[i].name);
+        }
+        for (int i = 0; i < numOrgs && i < numOld; i++) {
+            if (!orgReportChanged(&old[i], &now[i])) {
+                continue;
+            }
+            fprintf(out, "  ~ (%d) %s", i, now[i].name);
+            char* sep = ":";
+            if (now[i].numPrey != old[i].numPrey) {
+                fprintf(out, "%s prey %d -> %d", sep, old[i].numPrey, now[i].numPrey);
+                sep = ",";
+            }
+            if (now[i].eatenBy != old[i].eatenBy) {
+                fprintf(out, "%s predators %d -> %d", sep, old[i].eatenBy, now[i].eatenBy);
+                sep = ",";
+            }
+            if (now[i].height != old[i].height) {
+                fprintf(out, "%s height %d -> %d", sep, old[i].height, now[i].height);
+                sep = ",";
+            }
+            if (now[i].vore != old[i].vore) {
+                fprintf(out, "%s %s -> %s", sep, voreNames[old[i].vore], voreNames[now[i].vore]);
+            }
+            fprintf(out, "\n");
+        }
+        fprintf(out, "\n");
+    }
+
+    freeReportState(state);
+    state->orgs = now;
+    state->numOrgs = numOrgs;
+}
+
+/*
+Funciton: setModes
+Purpose: 
+    parse -b, -d, -q, -s, -m, -c, -e, -u flags from argv; each at most once,
+    and at most one of -s, -m and -e; -s cannot be combined with -b
+Parameters:
+    argc, argv, pBasicMode, pDebugMode, pQuietMode, pServerMode, pBatchMode, pCompactMode, pStreamMode, pDeltaMode
+Returns: 
+    true on success, false if any invalid/duplicate flag.
+*/
+bool setModes(int argc, char* argv[], bool* pBasicMode, bool* pDebugMode, bool* pQuietMode, bool* pServerMode, bool* pBatchMode, bool* pCompactMode, bool* pStreamMode, bool* pDeltaMode) {
+
+    int bCount = 0, dCount = 0, qCount = 0, sCount = 0, mCount = 0, cCount = 0, eCount = 0, uCount = 0;
+
+    *pDebugMode = false;
+    *pQuietMode = false;
+    *pBasicMode = false;
+    *pServerMode = false;
+    *pBatchMode = false;
+    *pCompactMode = false;
+    *pStreamMode = false;
+    *pDeltaMode = false;
+
+    for (int i = 1; i < argc; i++) {
+
+        char* s = argv[i];
+
+        if (strncmp(s,"-d",2) == 0) {
+            if (dCount == 1) {
+                return false;
+            }
+            else {
+                dCount++;
+                *pDebugMode = true;
+            }
+        }
+        else if (strncmp(s,"-b",2) == 0) {
             if (bCount == 1) {
                 return false;
             }
-            else {
-                bCount++;
-                *pBasicMode = true;
+            else {
+                bCount++;
+                *pBasicMode = true;
+            }
+        }
+        else if (strncmp(s,"-q",2) == 0) {
+            if (qCount == 1) {
+                return false;
+            }
+            else {
+                qCount++;
+                *pQuietMode = true;
+            }
+        }
+        else if (strncmp(s,"-s",2) == 0) {
+            if (sCount == 1) {
+                return false;
+            }
+            else {
+                sCount++;
+                *pServerMode = true;
+            }
+        }
+        else if (strncmp(s,"-m",2) == 0) {
+            if (mCount == 1) {
+                return false;
+            }
+            else {
+                mCount++;
+                *pBatchMode = true;
+            }
+        }
+        else if (strncmp(s,"-c",2) == 0) {
+            if (cCount == 1) {
+                return false;
+            }
+            else {
+                cCount++;
+                *pCompactMode = true;
+            }
+        }
+        else if (strncmp(s,"-e",2) == 0) {
+            if (eCount == 1) {
+                return false;
+            }
+            else {
+                eCount++;
+                *pStreamMode = true;
+            }
+        }
+        else if (strncmp(s,"-u",2) == 0) {
+            if (uCount == 1) {
+                return false;
+            }
+            else {
+                uCount++;
+                *pDeltaMode = true;
+            }
+        }
+        else {
+            return false;
+        }
+    }
+
+    if (sCount + mCount + eCount > 1) { // Server, batch and stream mode each replace the normal session
+        return false;
+    }
+
+    if (sCount == 1 && bCount == 1) { // Server webs are built with org/rel, a read-only server could never hold anything
+        return false;
+    }
+    
+    return true; 
+}
+
+void printONorOFF(bool mode) {
+    if (mode) {
+        printf("ON\n");
+    } else {
+        printf("OFF\n");
+    }
+}
+
+/*
+Struct: NamedWeb
+Purpose:
+    A food web kept resident by server mode and looked up by name.
+Fields:
+    name - fixed size name of the web
+    web - array of Org, NULL while the web is empty
+    numOrgs - number of organisms in web
+    report - what the last report or delta showed, for "delta"
+*/
+typedef struct NamedWeb_struct {
+    char name[20];
+    Org* web;
+    int numOrgs;
+    ReportState report;
+} NamedWeb;
+
+/*
+Function: findWeb
+Purpose:
+    Look up a resident web by name
+Parameters:
+    webs - array of NamedWeb
+    numWebs - number of webs
+    name - name to look for
+Returns:
+    index of the web, or -1 if there is no web with that name
+*/
+int findWeb(NamedWeb* webs, int numWebs, char* name) {
+    for (int i = 0; i < numWebs; i++) {
+        if (strcmp(webs[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+Function: addNamedWeb
+Purpose:
+    Appends a new, empty web to the heap-allocated server web array
+Parameters:
+    pWebs - address of the NamedWeb* array pointer
+    pNumWebs - address of the current number of webs
+    name - C string with the new web's name
+Returns:
+    index of the new web
+*/
+int addNamedWeb(NamedWeb** pWebs, int* pNumWebs, char* name) {
+
+    int oldSize = *pNumWebs;
+    int newSize = oldSize + 1;
+
+    NamedWeb* newArray = (NamedWeb*)malloc(newSize * sizeof(NamedWeb));
+
+    for (int i = 0; i < oldSize; i++) {
+        newArray[i] = (*pWebs)[i];
+    }
+    strcpy(newArray[oldSize].name, name);
+    newArray[oldSize].web = NULL;
+    newArray[oldSize].numOrgs = 0;
+    initReportState(&newArray[oldSize].report);
+
+    if (*pWebs != NULL) {
+        free(*pWebs);
+    }
+    *pWebs = newArray;
+    *pNumWebs = newSize;
+    return oldSize;
+}
+
+/*
+Function: removeNamedWeb
+Purpose:
+    Free one resident web and close the gap it leaves in the array
+Parameters:
+    webs - array of NamedWeb
+    pNumWebs - address of the number of webs
+    index - web to drop
+Returns:
+    void
+*/
+void removeNamedWeb(NamedWeb* webs, int* pNumWebs, int index) {
+    freeWeb(webs[index].web, webs[index].numOrgs);
+    freeReportState(&webs[index].report);
+    for (int i = index + 1; i < *pNumWebs; i++) {
+        webs[i - 1] = webs[i];
+    }
+    (*pNumWebs)--;
+}
+
+/*
+Function: runServer
+Purpose:
+    Long-running query mode. Keeps any number of named webs resident
+    and answers one command per line from stdin, so a web is built
+    once and queried many times instead of rebuilt per process.
+    Every reply ends with a line holding OK or ERROR, and stdout is
+    flushed after it so a client on the other end of a pipe can read
+    the reply before sending its next command. Commands run one at a
+    time, so each query sees the web exactly as the previous command
+    left it.
+Parameters:
+    debugMode - print the web after each change
+    quietMode - suppress the "> " prompt
+    compactMode - pack a predator's prey list again after each relation added
+Returns:
+    void
+*/
+void runServer(bool debugMode, bool quietMode, bool compactMode) {
+
+    NamedWeb* webs = NULL;
+    int numWebs = 0;
+    int cur = addNamedWeb(&webs, &numWebs, "default"); // Commands act on this web until "use" picks another
+
+    char line[256];
+    char cmd[20];
+    char arg[20];
+
+    if (!quietMode) printf("> ");
+    fflush(stdout);
+
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+
+        if (strchr(line, '\n') == NULL && !feof(stdin)) { // Drop the rest so it is not read as another command
+            int c;
+            while ((c = getchar()) != '\n' && c != EOF) { }
+            printf("Line too long.\nERROR\n");
+            if (!quietMode) printf("> ");
+            fflush(stdout);
+            continue;
+        }
+
+        if (sscanf(line, "%19s", cmd) != 1) { // Blank line, nothing to answer
+            if (!quietMode) printf("> ");
+            fflush(stdout);
+            continue;
+        }
+
+        bool ok = true;
+        bool changed = false;
+        Org* web = webs[cur].web;
+        int numOrgs = webs[cur].numOrgs;
+
+        if (strcmp(cmd, "quit") == 0) {
+            printf("OK\n");
+            break;
+
+        } else if (strcmp(cmd, "help") == 0) {
+            printf("  webs | use <web> | drop <web>\n");
+            printf("  org <name> | rel <predator index> <prey index> | ext <index>\n");
+            printf("  print | apex | producers | heights | vores | report | delta [json] | quit\n");
+
+        } else if (strcmp(cmd, "webs") == 0) {
+            for (int i = 0; i < numWebs; i++) {
+                printf("  %c %s (%d organisms)\n", (i == cur) ? '*' : ' ', webs[i].name, webs[i].numOrgs);
+            }
+
+        } else if (strcmp(cmd, "use") == 0) {
+            if (sscanf(line, "%*s %19s", arg) != 1) {
+                printf("Missing web name.\n");
+                ok = false;
+            } else {
+                cur = findWeb(webs, numWebs, arg);
+                if (cur < 0) {
+                    cur = addNamedWeb(&webs, &numWebs, arg);
+                }
+            }
+
+        } else if (strcmp(cmd, "drop") == 0) {
+            int ind = -1;
+            if (sscanf(line, "%*s %19s", arg) == 1) {
+                ind = findWeb(webs, numWebs, arg);
+            }
+            if (ind < 0) {
+                printf("Unknown web. No web dropped.\n");
+                ok = false;
+            } else {
+                removeNamedWeb(webs, &numWebs, ind);
+                if (numWebs == 0) {
+                    addNamedWeb(&webs, &numWebs, "default");
+                }
+                if (cur == ind) {
+                    cur = 0;
+                } else if (cur > ind) {
+                    cur--;
+                }
+            }
+
+        } else if (strcmp(cmd, "org") == 0) {
+            if (sscanf(line, "%*s %19s", arg) != 1) {
+                printf("Missing organism name.\n");
+                ok = false;
+            } else {
+                printf("Species Expansion: %s\n", arg);
+                addOrgToWeb(&webs[cur].web, &webs[cur].numOrgs, arg);
+                changed = true;
+            }
+
+        } else if (strcmp(cmd, "rel") == 0) {
+            int predInd, preyInd;
+            if (sscanf(line, "%*s %d %d", &predInd, &preyInd) != 2) {
+                printf("Missing predator and/or prey index.\n");
+                ok = false;
+            } else if (addRelationToWeb(web, numOrgs, predInd, preyInd, stdout)) {
+                printf("New Food Source: %s eats %s\n", web[predInd].name, web[preyInd].name);
+                if (compactMode) {
+                    packOrg(&web[predInd]);
+                }
+                changed = true;
+            } else {
+                ok = false;
+            }
+
+        } else if (strcmp(cmd, "ext") == 0) {
+            int extInd;
+            if (sscanf(line, "%*s %d", &extInd) != 1 || extInd < 0 || extInd >= numOrgs) {
+                printf("Invalid index for species extinction\n");
+                ok = false;
+            } else {
+                printf("Species Extinction: %s\n", web[extInd].name);
+                removeOrgFromWeb(&webs[cur].web, &webs[cur].numOrgs, extInd);
+                reportOrgRemoved(&webs[cur].report, extInd);
+                changed = true;
+            }
+
+        } else if (strcmp(cmd, "print") == 0) {
+            printWeb(web, numOrgs, stdout);
+
+        } else if (strcmp(cmd, "apex") == 0) {
+            int* eatenBy = eatenByCounts(web, numOrgs);
+            printApexPredators(web, numOrgs, eatenBy, stdout);
+            free(eatenBy);
+
+        } else if (strcmp(cmd, "producers") == 0) {
+            printProducers(web, numOrgs, stdout);
+
+        } else if (strcmp(cmd, "heights") == 0) {
+            int* heights = calculateHeights(web, numOrgs);
+            printHeights(web, numOrgs, heights, stdout);
+            free(heights);
+
+        } else if (strcmp(cmd, "vores") == 0) {
+            printVoreTypes(web, numOrgs, stdout);
+
+        } else if (strcmp(cmd, "report") == 0) {
+            displayAll(web, numOrgs, false, stdout);
+            recordReport(&webs[cur].report, web, numOrgs);
+
+        } else if (strcmp(cmd, "delta") == 0) {
+            bool json = (sscanf(line, "%*s %19s", arg) == 1 && strcmp(arg, "json") == 0);
+            displayDelta(web, numOrgs, &webs[cur].report, json, stdout);
+
+        } else {
+            printf("Unknown command: %s\n", cmd);
+            ok = false;
+        }
+
+        if (changed && debugMode) {
+            printf("DEBUG MODE - modified web %s:\n", webs[cur].name);
+            printWeb(webs[cur].web, webs[cur].numOrgs, stdout);
+        }
+
+        printf("%s\n", ok ? "OK" : "ERROR");
+        if (!quietMode) printf("> ");
+        fflush(stdout);
+    }
+
+    for (int i = 0; i < numWebs; i++) {
+        freeWeb(webs[i].web, webs[i].numOrgs);
+        freeReportState(&webs[i].report);
+    }
+    free(webs);
+}
+
+/*
+Function: loadWebFile
+Purpose:
+    Build a web from a file laid out like the initial build on stdin:
+    organism names up to DONE, then <predator index> <prey index>
+    pairs up to the first invalid pair or the end of the file
+Parameters:
+    path - file to read
+    pWeb - address of the Org* array pointer (NULL on entry)
+    pNumOrgs - address of the size (0 on entry)
+    compact - pack each predator's prey list as relations are added,
+              so the plain lists never all exist at once
+    out - stream for messages about skipped relations
+Returns:
+    true if the file was read, false if it could not be opened
+*/
+bool loadWebFile(char* path, Org** pWeb, int* pNumOrgs, bool compact, FILE* out) {
+
+    FILE* in = fopen(path, "r");
+    if (in == NULL) {
+        return false;
+    }
+
+    char tempName[20] = "";
+    while (fscanf(in, "%19s", tempName) == 1 && strcmp(tempName, "DONE") != 0) {
+        addOrgToWeb(pWeb, pNumOrgs, tempName);
+    }
+
+    Org* web = *pWeb;
+    int numOrgs = *pNumOrgs;
+    int predInd, preyInd;
+    while (fscanf(in, "%d %d", &predInd, &preyInd) == 2
+           && predInd >= 0 && preyInd >= 0 && predInd < numOrgs && preyInd < numOrgs && predInd != preyInd) {
+        if (addRelationToWeb(web, numOrgs, predInd, preyInd, out) && compact) {
+            packOrg(&web[predInd]);
+        }
+    }
+
+    fclose(in);
+    return true;
+}
+
+/*
+Struct: BatchJob
+Purpose:
+    One web file in a batch run and the report produced for it.
+Fields:
+    path - web file, heap allocated
+    size - file size in bytes, used to start the biggest webs first
+    report - heap buffer with the finished report
+    reportLen - length of report
+*/
+typedef struct BatchJob_struct {
+    char* path;
+    long size;
+    char* report;
+    size_t reportLen;
+} BatchJob;
+
+/*
+Struct: BatchQueue
+Purpose:
+    Work shared by the batch worker threads.
+Fields:
+    jobs - array of BatchJob
+    order - job indices, biggest file first
+    numJobs - number of jobs
+    next - position in order of the next unclaimed job
+    compact - keep prey lists packed while loading (-c)
+    lock - guards next
+*/
+typedef struct BatchQueue_struct {
+    BatchJob* jobs;
+    int* order;
+    int numJobs;
+    int next;
+    bool compact;
+    pthread_mutex_t lock;
+} BatchQueue;
+
+/*
+Function: analyzeBatchJob
+Purpose:
+    Load one web file and write its full report into the job's buffer
+Parameters:
+    job - the job to run
+    compact - keep prey lists packed while loading
+Returns:
+    void
+*/
+void analyzeBatchJob(BatchJob* job, bool compact) {
+
+    FILE* out = open_memstream(&job->report, &job->reportLen);
+    if (out == NULL) {
+        return;
+    }
+
+    Org* web = NULL;
+    int numOrgs = 0;
+
+    fprintf(out, "==== %s ====\n", job->path);
+    if (loadWebFile(job->path, &web, &numOrgs, compact, out)) {
+        displayAll(web, numOrgs, false, out);
+    }
+    else {
+        fprintf(out, "Could not open web file.\n\n");
+    }
+
+    freeWeb(web, numOrgs);
+    fclose(out);
+}
+
+/*
+Function: batchWorker
+Purpose:
+    Thread body: keep claiming the next unclaimed job until none are left.
+    Jobs are claimed one at a time, so a thread that drew small webs
+    simply claims more of them while another is busy with a big one.
+Parameters:
+    arg - the shared BatchQueue
+Returns:
+    NULL
+*/
+void* batchWorker(void* arg) {
+
+    BatchQueue* queue = (BatchQueue*)arg;
+
+    while (true) {
+        pthread_mutex_lock(&queue->lock);
+        int pos = queue->next;
+        if (pos < queue->numJobs) {
+            queue->next++;
+        }
+        pthread_mutex_unlock(&queue->lock);
+
+        if (pos >= queue->numJobs) {
+            break;
+        }
+        analyzeBatchJob(&queue->jobs[queue->order[pos]], queue->compact);
+    }
+    return NULL;
+}
+
+BatchJob* sortJobs; // Jobs being ordered by compareJobSize, qsort has no context argument
+
+/*
+Function: compareJobSize
+Purpose:
+    qsort comparator ordering job indices by file size, biggest first
+Parameters:
+    a, b - pointers into BatchQueue.order
+Returns:
+    negative, zero or positive as for qsort
+*/
+int compareJobSize(const void* a, const void* b) {
+    long sa = sortJobs[*(const int*)a].size;
+    long sb = sortJobs[*(const int*)b].size;
+    if (sa > sb) return -1;
+    if (sa < sb) return 1;
+    return *(const int*)a - *(const int*)b;
+}
+
+/*
+Function: runBatch
+Purpose:
+    Batch mode. Reads web file paths from stdin, one per line,
+    analyzes them on one thread per CPU, and prints every report
+    to stdout in manifest order once all of them are done. The
+    biggest files are started first so one large web does not
+    end up running alone at the tail of the batch.
+Parameters:
+    compactMode - keep prey lists packed while loading
+Returns:
+    void
+*/
+void runBatch(bool compactMode) {
+
+    BatchQueue queue;
+    queue.jobs = NULL;
+    queue.numJobs = 0;
+    queue.next = 0;
+    queue.compact = compactMode;
+    pthread_mutex_init(&queue.lock, NULL);
+
+    char line[4096];
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') {
+            continue;
+        }
+
+        BatchJob* newArray = (BatchJob*)malloc((queue.numJobs + 1) * sizeof(BatchJob));
+        for (int i = 0; i < queue.numJobs; i++) {
+            newArray[i] = queue.jobs[i];
+        }
+        struct stat st;
+        BatchJob* job = &newArray[queue.numJobs];
+        job->path = (char*)malloc(strlen(line) + 1);
+        strcpy(job->path, line);
+        job->size = (stat(line, &st) == 0) ? (long)st.st_size : 0;
+        job->report = NULL;
+        job->reportLen = 0;
+
+        free(queue.jobs);
+        queue.jobs = newArray;
+        queue.numJobs++;
+    }
+
+    queue.order = (int*)malloc(sizeof(int) * (queue.numJobs + 1));
+    for (int i = 0; i < queue.numJobs; i++) {
+        queue.order[i] = i;
+    }
+    sortJobs = queue.jobs;
+    qsort(queue.order, queue.numJobs, sizeof(int), compareJobSize);
+
+    long numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    if (numThreads > queue.numJobs) {
+        numThreads = queue.numJobs;
+    }
+
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * (numThreads + 1));
+    long numStarted = 0;
+    for (long t = 0; t < numThreads; t++) {
+        if (pthread_create(&threads[numStarted], NULL, batchWorker, &queue) == 0) {
+            numStarted++;
+        }
+    }
+    if (numStarted == 0) { // No thread could be started, work through the queue here instead
+        batchWorker(&queue);
+    }
+    for (long t = 0; t < numStarted; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    for (int i = 0; i < queue.numJobs; i++) {
+        if (queue.jobs[i].report != NULL) {
+            fwrite(queue.jobs[i].report, 1, queue.jobs[i].reportLen, stdout);
+            free(queue.jobs[i].report);
+        }
+        free(queue.jobs[i].path);
+    }
+
+    free(threads);
+    free(queue.order);
+    free(queue.jobs);
+    pthread_mutex_destroy(&queue.lock);
+}
+
+#define STREAM_RUN_EDGES (1 << 22) // Relations sorted in memory at a time in stream mode (8 bytes each)
+#define STREAM_MERGE_WAYS 64 // Sorted runs merged at once in stream mode
+#define STREAM_MERGE_LEVELS 8 // Levels of runs waiting to merge, the top one is merged back into itself
+
+/*
+Struct: Edge
+Purpose:
+    One predator->prey relation as stored in stream mode's temporary files.
+Fields:
+    pred - predator index
+    prey - prey index
+*/
+typedef struct Edge_struct {
+    int pred;
+    int prey;
+} Edge;
+
+/*
+Function: compareEdges
+Purpose:
+    qsort comparator ordering edges by predator, then prey
+Parameters:
+    a, b - pointers to Edge
+Returns:
+    negative, zero or positive as for qsort
+*/
+int compareEdges(const void* a, const void* b) {
+    const Edge* x = (const Edge*)a;
+    const Edge* y = (const Edge*)b;
+    if (x->pred != y->pred) {
+        return (x->pred > y->pred) - (x->pred < y->pred);
+    }
+    return (x->prey > y->prey) - (x->prey < y->prey);
+}
+
+/*
+Function: writeRun
+Purpose:
+    Sort a buffer of edges, drop repeats and write it to a new temporary file
+Parameters:
+    buf - edges, sorted in place
+    n - number of edges in buf
+    pDuplicates - incremented once per dropped repeat
+Returns:
+    the temporary file rewound for reading, or NULL if it could not be created or written
+*/
+FILE* writeRun(Edge* buf, int n, long* pDuplicates) {
+
+    FILE* run = tmpfile();
+    if (run == NULL) {
+        return NULL;
+    }
+
+    qsort(buf, n, sizeof(Edge), compareEdges);
+    for (int i = 0; i < n; i++) {
+        if (i > 0 && compareEdges(&buf[i], &buf[i - 1]) == 0) {
+            (*pDuplicates)++;
+            continue;
+        }
+        if (fwrite(&buf[i], sizeof(Edge), 1, run) != 1) {
+            break;
+        }
+    }
+
+    if (fflush(run) != 0 || ferror(run)) { // Most likely a full disk, the run would be cut short
+        fclose(run);
+        return NULL;
+    }
+    rewind(run);
+    return run;
+}
+
+/*
+Function: mergeRuns
+Purpose:
+    Merge sorted runs into one sorted run, dropping repeats that
+    landed in different runs. A small heap keyed on each run's next
+    edge picks the smallest edge, so every run is read once, in order.
+    The input runs are closed on success and left open on failure.
+Parameters:
+    runs - array of k sorted runs
+    k - number of runs, at most STREAM_MERGE_WAYS
+    pDuplicates - incremented once per dropped repeat
+Returns:
+    the merged run rewound for reading, or NULL if it could not be created or written
+*/
+FILE* mergeRuns(FILE** runs, int k, long* pDuplicates) {
+
+    FILE* merged = tmpfile();
+    if (merged == NULL) {
+        return NULL;
+    }
+
+    Edge head[STREAM_MERGE_WAYS]; // Next edge of each run
+    int heap[STREAM_MERGE_WAYS]; // Run numbers, smallest head on top
+    int heapSize = 0;
+
+    for (int r = 0; r < k; r++) {
+        if (fread(&head[r], sizeof(Edge), 1, runs[r]) != 1) {
+            continue;
+        }
+        int c = heapSize++;
+        while (c > 0 && compareEdges(&head[r], &head[heap[(c - 1) / 2]]) < 0) { // Sift up
+            heap[c] = heap[(c - 1) / 2];
+            c = (c - 1) / 2;
+        }
+        heap[c] = r;
+    }
+
+    bool any = false;
+    bool failed = false;
+    Edge last = { 0, 0 };
+    while (heapSize > 0 && !failed) {
+        int r = heap[0];
+        Edge e = head[r];
+
+        if (any && compareEdges(&e, &last) == 0) {
+            (*pDuplicates)++;
+        }
+        else {
+            failed = (fwrite(&e, sizeof(Edge), 1, merged) != 1);
+            last = e;
+            any = true;
+        }
+
+        if (fread(&head[r], sizeof(Edge), 1, runs[r]) != 1) { // Run used up, move the last run to the top
+            r = heap[--heapSize];
+        }
+        int c = 0;
+        while (true) { // Sift down
+            int child = 2 * c + 1;
+            if (child >= heapSize) {
+                break;
+            }
+            if (child + 1 < heapSize && compareEdges(&head[heap[child + 1]], &head[heap[child]]) < 0) {
+                child++;
             }
+            if (compareEdges(&head[heap[child]], &head[r]) >= 0) {
+                break;
+            }
+            heap[c] = heap[child];
+            c = child;
         }
-        else if (strncmp(s,"-q",2) == 0) {
-            if (qCount == 1) {
-                return false;
+        if (heapSize > 0) {
+            heap[c] = r;
+        }
+    }
+
+    if (failed || fflush(merged) != 0 || ferror(merged)) { // Most likely a full disk, the merged run would be cut short
+        fclose(merged);
+        return NULL;
+    }
+
+    for (int r = 0; r < k; r++) {
+        fclose(runs[r]);
+    }
+    rewind(merged);
+    return merged;
+}
+
+/*
+Function: sortEdges
+Purpose:
+    Build stream mode's sorted relation file. Relations are sorted
+    runEdges at a time into runs. As soon as STREAM_MERGE_WAYS runs
+    wait on one level they are merged into a single run on the next
+    level up, so open temporary files stay below STREAM_MERGE_WAYS
+    per level however many relations come in. At the end each level
+    is merged into the one above until a single file is left.
+Parameters:
+    nextEdge - stores the next relation in *e, returns false when there are no more
+    source - passed to nextEdge
+    runEdges - relations sorted in memory at a time
+    pDuplicates - incremented once per dropped repeat
+Returns:
+    the sorted relation file rewound for reading, or NULL if a
+    temporary file could not be created or written
+*/
+FILE* sortEdges(bool (*nextEdge)(void* source, Edge* e), void* source, int runEdges, long* pDuplicates) {
+
+    FILE* level[STREAM_MERGE_LEVELS][STREAM_MERGE_WAYS]; // Runs waiting to merge, a level L run holds about runEdges * STREAM_MERGE_WAYS^L relations
+    int numLevel[STREAM_MERGE_LEVELS];
+    for (int L = 0; L < STREAM_MERGE_LEVELS; L++) {
+        numLevel[L] = 0;
+    }
+
+    Edge* buf = (Edge*)malloc(sizeof(Edge) * runEdges);
+    int n = 0;
+    bool written = false; // At least one run, so an empty input still gives a file
+    bool more = true;
+    bool ok = true;
+
+    while (ok && more) {
+        more = nextEdge(source, &buf[n]);
+        if (more) {
+            n++;
+        }
+        if (n < runEdges && (more || (n == 0 && written))) {
+            continue;
+        }
+
+        FILE* run = writeRun(buf, n, pDuplicates);
+        ok = (run != NULL);
+        n = 0;
+        written = true;
+
+        int L = 0;
+        while (ok) { // Carry full levels up
+            level[L][numLevel[L]++] = run;
+            if (numLevel[L] < STREAM_MERGE_WAYS) {
+                break;
+            }
+            run = mergeRuns(level[L], numLevel[L], pDuplicates);
+            ok = (run != NULL); // On failure the level's runs stay open, they are closed below
+            if (ok) {
+                numLevel[L] = 0;
+                if (L + 1 < STREAM_MERGE_LEVELS) {
+                    L++;
+                }
+            }
+        }
+    }
+    free(buf);
+
+    FILE* edges = NULL;
+    for (int L = 0; ok && L < STREAM_MERGE_LEVELS; L++) { // Merge what is left, lowest level first
+        if (numLevel[L] == 0) {
+            continue;
+        }
+        bool top = true;
+        for (int u = L + 1; u < STREAM_MERGE_LEVELS; u++) {
+            if (numLevel[u] > 0) {
+                top = false;
+            }
+        }
+        FILE* run = (numLevel[L] == 1) ? level[L][0] : mergeRuns(level[L], numLevel[L], pDuplicates);
+        ok = (run != NULL);
+        if (ok) {
+            numLevel[L] = 0;
+            if (top) {
+                edges = run;
             }
             else {
-                qCount++;
-                *pQuietMode = true;
+                level[L + 1][numLevel[L + 1]++] = run; // At most STREAM_MERGE_WAYS - 1 waited there
             }
         }
+    }
+
+    if (!ok) {
+        for (int L = 0; L < STREAM_MERGE_LEVELS; L++) {
+            for (int r = 0; r < numLevel[L]; r++) {
+                fclose(level[L][r]);
+            }
+        }
+    }
+    return edges;
+}
+
+/*
+Function: scanEdge
+Purpose:
+    sortEdges source for stream mode: the next relation pair on stdin
+Parameters:
+    source - address of the number of organisms
+    e - receives the relation
+Returns:
+    true if a valid pair was read, false at the end of input or at
+    the first invalid pair, where building the web stops
+*/
+bool scanEdge(void* source, Edge* e) {
+    int numOrgs = *(int*)source;
+    return scanf("%d %d", &e->pred, &e->prey) == 2 && e->pred >= 0 && e->prey >= 0
+           && e->pred < numOrgs && e->prey < numOrgs && e->pred != e->prey;
+}
+
+/*
+Function: printWebFromEdges
+Purpose:
+    printWeb for stream mode, reading prey from the sorted relation
+    file instead of the organisms. Prey come out in index order.
+Parameters:
+    web, numOrgs, edges - sorted relation file, rewound afterwards,
+    out - stream to print to
+Returns:
+    void
+*/
+void printWebFromEdges(Org* web, int numOrgs, FILE* edges, FILE* out) {
+    Edge e;
+    bool more = (fread(&e, sizeof(Edge), 1, edges) == 1);
+
+    for (int i = 0; i < numOrgs; i++) {
+        fprintf(out, "  (%d) %s", i, web[i].name);
+        if (more && e.pred == i) {
+            fprintf(out, " eats %s", web[e.prey].name);
+            more = (fread(&e, sizeof(Edge), 1, edges) == 1);
+            while (more && e.pred == i) {
+                fprintf(out, ", %s", web[e.prey].name);
+                more = (fread(&e, sizeof(Edge), 1, edges) == 1);
+            }
+        }
+        fprintf(out, "\n");
+    }
+    fprintf(out, "\n");
+    rewind(edges);
+}
+
+/*
+Function: streamHeights
+Purpose:
+    calculateHeights for stream mode: each pass reads the relation
+    file once and raises predators above their prey, until a pass
+    changes nothing
+Parameters:
+    numOrgs, edges - sorted relation file, rewound afterwards
+Returns:
+    an int array of size numOrgs, caller frees it
+*/
+int* streamHeights(int numOrgs, FILE* edges) {
+    int* height = (int*)malloc(sizeof(int)*numOrgs);
+
+    for (int i = 0; i < numOrgs; i++) {
+        height[i] = 0;
+    }
+
+    int change = 1;
+    while (change) {
+        change = 0;
+        Edge e;
+        bool more = (fread(&e, sizeof(Edge), 1, edges) == 1);
+        while (more) {
+            int pred = e.pred;
+            int maxPreyHeight = 0;
+            while (more && e.pred == pred) {
+                if (height[e.prey] > maxPreyHeight) {
+                    maxPreyHeight = height[e.prey];
+                }
+                more = (fread(&e, sizeof(Edge), 1, edges) == 1);
+            }
+            if (maxPreyHeight + 1 != height[pred]) {
+                height[pred] = maxPreyHeight + 1;
+                change = 1;
+            }
+        }
+        rewind(edges);
+    }
+    return height;
+}
+
+/*
+Function: streamVores
+Purpose:
+    classifyVores for stream mode, in one pass over the relation file.
+    web[].numPrey must already hold each organism's prey count.
+Parameters:
+    web, numOrgs, edges - sorted relation file, rewound afterwards
+Returns:
+    an int array of size numOrgs holding VoreType values, caller frees it
+*/
+int* streamVores(Org* web, int numOrgs, FILE* edges) {
+    int* eats = (int*)malloc(sizeof(int)*numOrgs); // bit 1 = eats producers, bit 2 = eats consumers
+
+    for (int i = 0; i < numOrgs; i++) {
+        eats[i] = 0;
+    }
+
+    Edge e;
+    while (fread(&e, sizeof(Edge), 1, edges) == 1) {
+        eats[e.pred] |= (web[e.prey].numPrey == 0) ? 1 : 2;
+    }
+    rewind(edges);
+
+    for (int i = 0; i < numOrgs; i++) {
+        if (eats[i] == 0) {
+            eats[i] = PRODUCER;
+        }
+        else if (eats[i] == 1) {
+            eats[i] = HERBIVORE;
+        }
+        else if (eats[i] == 3) {
+            eats[i] = OMNIVORE;
+        }
         else {
-            return false;
+            eats[i] = CARNIVORE;
         }
     }
-    
-    return true; 
+    return eats;
 }
 
-void printONorOFF(bool mode) {
-    if (mode) {
-        printf("ON\n");
-    } else {
-        printf("OFF\n");
+/*
+Function: printStreamReport
+Purpose:
+    displayAll for stream mode. One pass over the relation file counts
+    prey and predators, then every section is printed from those
+    counts and further passes over the file.
+Parameters:
+    web - organisms with numPrey 0, filled in here
+    numOrgs, edges - sorted relation file, rewound afterwards,
+    out - stream to print to
+Returns:
+    void
+*/
+void printStreamReport(Org* web, int numOrgs, FILE* edges, FILE* out) {
+
+    int* eatenBy = (int*)malloc(sizeof(int)*numOrgs);
+    for (int i = 0; i < numOrgs; i++) {
+        eatenBy[i] = 0;
+    }
+    Edge e;
+    while (fread(&e, sizeof(Edge), 1, edges) == 1) {
+        web[e.pred].numPrey++;
+        eatenBy[e.prey]++;
+    }
+    rewind(edges);
+
+    fprintf(out, "Food Web Predators & Prey:\n");
+    printWebFromEdges(web, numOrgs, edges, out);
+
+    fprintf(out, "Apex Predators:\n");
+    printApexPredators(web, numOrgs, eatenBy, out);
+
+    fprintf(out, "Producers:\n");
+    printProducers(web, numOrgs, out);
+
+    fprintf(out, "Most Flexible Eaters:\n");
+    printMostFlexibleEaters(web, numOrgs, out);
+
+    fprintf(out, "Tastiest Food:\n");
+    printTastiestFood(web, numOrgs, eatenBy, out);
+    free(eatenBy);
+
+    fprintf(out, "Food Web Heights:\n");
+    int* heights = streamHeights(numOrgs, edges);
+    printHeights(web, numOrgs, heights, out);
+    free(heights);
+    fprintf(out, "\n");
+
+    fprintf(out, "Vore Types:\n");
+    int* vore = streamVores(web, numOrgs, edges);
+    printVoreClasses(web, numOrgs, vore, out);
+    free(vore);
+}
+
+/*
+Function: runStream
+Purpose:
+    Stream mode. Reads a web laid out like a web file (names up to
+    DONE, then relation pairs up to the first invalid pair) from stdin
+    and prints the same report as displayAll, without ever holding all
+    relations in memory. sortEdges turns the relations into one sorted
+    file with repeats dropped, and every analysis is then one or more
+    sequential passes over that file. Memory use is the organisms plus a few ints each.
+Parameters:
+    none
+Returns:
+    true when the report was printed, false if a temporary file
+    could not be created or written
+*/
+bool runStream() {
+
+    int numOrgs = 0;
+    int capacity = 16;
+    Org* web = (Org*)malloc(sizeof(Org) * capacity); // Grows by doubling, addOrgToWeb copies on every add
+
+    char tempName[20] = "";
+    while (scanf("%19s", tempName) == 1 && strcmp(tempName, "DONE") != 0) {
+        if (numOrgs == capacity) {
+            capacity *= 2;
+            Org* newArray = (Org*)malloc(sizeof(Org) * capacity);
+            for (int i = 0; i < numOrgs; i++) {
+                newArray[i] = web[i];
+            }
+            free(web);
+            web = newArray;
+        }
+        strcpy(web[numOrgs].name, tempName);
+        web[numOrgs].prey = NULL; // Only numPrey is filled in, prey stay on disk
+        web[numOrgs].numPrey = 0;
+        web[numOrgs].lastPrey = 0;
+        web[numOrgs].packed = NULL;
+        numOrgs++;
     }
+
+    long duplicates = 0;
+    FILE* edges = sortEdges(scanEdge, &numOrgs, STREAM_RUN_EDGES, &duplicates);
+    if (edges == NULL) {
+        free(web);
+        return false;
+    }
+
+    for (long d = 0; d < duplicates; d++) {
+        printf("Duplicate predator/prey relation. No relation added to the food web.\n");
+    }
+
+    printStreamReport(web, numOrgs, edges, stdout);
+
+    fclose(edges);
+    free(web);
+    return true;
 }
 
+#ifndef FOODWEB_NO_MAIN // verify.c includes this file and brings its own main
+
 /*
 Function: main
 Purpose: 
@@ -621,13 +2295,36 @@ int main(int argc, char* argv[]) {
     bool basicMode = false; // -b (read only)
     bool debugMode = false; // -d print extra after each change
     bool quietMode = false; // -q suppress user prompts (program output is still printed)
-
-    // Parse -b/-d/-q at most once each
-    if (!setModes(argc, argv, &basicMode, &debugMode, &quietMode)) { // If input is invalid (Duplicates or invalid arguments, no flags is still valid)
+    bool serverMode = false; // -s keep webs resident and answer line commands instead
+    bool batchMode = false; // -m analyze every web file listed on stdin
+    bool compactMode = false; // -c keep prey lists packed (see packOrg)
+    bool streamMode = false; // -e analyze a web too big for memory straight from stdin
+    bool deltaMode = false; // -u 'd' shows only what changed since the last display
+
+    // Parse -b/-d/-q/-s/-m/-c/-e/-u at most once each
+    if (!setModes(argc, argv, &basicMode, &debugMode, &quietMode, &serverMode, &batchMode, &compactMode, &streamMode, &deltaMode)) { // If input is invalid (Duplicates or invalid arguments, no flags is still valid)
         printf("Invalid command-line argument. Terminating program...\n");
         return 1;
     }
 
+    if (serverMode) { // Server mode replaces the build/modify session entirely
+        runServer(debugMode, quietMode, compactMode);
+        return 0;
+    }
+
+    if (batchMode) { // Batch mode reads a manifest of web files instead of one web
+        runBatch(compactMode);
+        return 0;
+    }
+
+    if (streamMode) { // Stream mode keeps relations on disk instead of in the web
+        if (!runStream()) {
+            printf("Could not write a temporary file. Terminating program...\n");
+            return 1;
+        }
+        return 0;
+    }
+
     // Prints which modes are ON/OFF
     printf("Program Settings:\n");
     printf("  basic mode = ");
@@ -655,7 +2352,7 @@ int main(int argc, char* argv[]) {
         addOrgToWeb(&web,&numOrgs,tempName); // Calls function that will add the organism to the web
         if (debugMode) { // Prints some extra info after each change 
             printf("DEBUG MODE - added an organism:\n");
-            printWeb(web,numOrgs);
+            printWeb(web,numOrgs,stdout);
             printf("\n");
         }
         if (!quietMode) printf("Enter the name for an organism in the web (or enter DONE): ");
@@ -675,10 +2372,12 @@ int main(int argc, char* argv[]) {
     if (!quietMode) printf("\n");
 
     while (predInd >= 0 && preyInd >= 0 && predInd < numOrgs &&  preyInd < numOrgs && predInd != preyInd) { // Loops while the indices are valid
-        addRelationToWeb(web,numOrgs,predInd,preyInd); // Calls function that will add the new relation to the web
+        if (addRelationToWeb(web,numOrgs,predInd,preyInd,stdout) && compactMode) { // Calls function that will add the new relation to the web
+            packOrg(&web[predInd]); // -c packs each list as it grows, the plain lists never all exist at once
+        }
         if (debugMode) { // Prints extra info if in debug mode
             printf("DEBUG MODE - added a relation:\n");
-            printWeb(web,numOrgs);
+            printWeb(web,numOrgs,stdout);
             printf("\n");
         }
         if (!quietMode) printf("Enter the pair of indices for a predator/prey relation.\n");
@@ -694,7 +2393,11 @@ int main(int argc, char* argv[]) {
     printf("Initial food web complete.\n");
     printf("Displaying characteristics for the initial food web...\n");
     
-    displayAll(web,numOrgs,false); // Calls function that displays all the analyses of the food web
+    displayAll(web,numOrgs,false,stdout); // Calls function that displays all the analyses of the food web
+
+    ReportState lastReport; // What the last display showed, for -u
+    initReportState(&lastReport);
+    if (deltaMode) recordReport(&lastReport,web,numOrgs);
 
     // Interactive modification menu
     if (!basicMode) { // Only runs if the user is not in the basic mode (the user can modify the web)
@@ -709,7 +2412,11 @@ int main(int argc, char* argv[]) {
                 printf("   r = add a new predator/prey relation (supplementation)\n");
                 printf("   x = remove an organism (extinction)\n");
                 printf("   p = print the updated food web\n");
-                printf("   d = display ALL characteristics for the updated food web\n");
+                if (deltaMode) {
+                    printf("   d = display what changed since the last display\n");
+                } else {
+                    printf("   d = display ALL characteristics for the updated food web\n");
+                }
                 printf("   q = quit\n");
                 printf("Enter a character (o, r, x, p, d, or q): ");
             }
@@ -727,7 +2434,7 @@ int main(int argc, char* argv[]) {
 
                 if (debugMode) {
                     printf("DEBUG MODE - added an organism:\n");
-                    printWeb(web,numOrgs);
+                    printWeb(web,numOrgs,stdout);
                     printf("\n");
                 }
 
@@ -739,6 +2446,7 @@ int main(int argc, char* argv[]) {
                 if (extInd >= 0 && extInd < numOrgs) { // Checks if index is valid
                     printf("Species Extinction: %s\n", web[extInd].name);
                     removeOrgFromWeb(&web,&numOrgs,extInd); // Calls the function that removes the organism from the web
+                    reportOrgRemoved(&lastReport,extInd); // Keeps the last display lined up with the new indices
                 } else {
                     printf("Invalid index for species extinction\n"); // Printed if the index is invalid
                 }
@@ -746,7 +2454,7 @@ int main(int argc, char* argv[]) {
                 
                 if (debugMode) {
                     printf("DEBUG MODE - removed an organism:\n");
-                    printWeb(web,numOrgs);
+                    printWeb(web,numOrgs,stdout);
                     printf("\n");
                 }
 
@@ -756,25 +2464,30 @@ int main(int argc, char* argv[]) {
                 scanf("%d %d",&predInd, &preyInd); // Reads in indices of predator and prey
                 if (!quietMode) printf("\n");
 
-                if (addRelationToWeb(web,numOrgs,predInd,preyInd)) { // Checks if the new relation is valid and adds it to the web
+                if (addRelationToWeb(web,numOrgs,predInd,preyInd,stdout)) { // Checks if the new relation is valid and adds it to the web
                     printf("New Food Source: %s eats %s\n", web[predInd].name, web[preyInd].name); // Prints the new relation
+                    if (compactMode) packOrg(&web[predInd]); // Packs the list addRelationToWeb just unpacked
                 };
                 printf("\n");
                 if (debugMode) {
                     printf("DEBUG MODE - added a relation:\n");
-                    printWeb(web,numOrgs);
+                    printWeb(web,numOrgs,stdout);
                     printf("\n");
                 }
 
             } else if (opt == 'p') { // Prints the updated food if user enters 'p', print only, no memory changes
                 printf("UPDATED Food Web Predators & Prey:\n");
-                printWeb(web,numOrgs); // Calls the function that prints the web
+                printWeb(web,numOrgs,stdout); // Calls the function that prints the web
                 printf("\n");
                 
+            } else if (opt == 'd' && deltaMode) { // Displays only what changed since the last 'd'
+                printf("Displaying changes for the UPDATED food web...\n\n");
+                displayDelta(web,numOrgs,&lastReport,false,stdout);
+
             } else if (opt == 'd') { // Displays all the characteristics for the updated food web if user enters 'd'
                 // Full analysis
                 printf("Displaying characteristics for the UPDATED food web...\n\n");
-                displayAll(web,numOrgs,true); // Calls the function that displays it all
+                displayAll(web,numOrgs,true,stdout); // Calls the function that displays it all
 
             }
             printf("--------------------------------\n\n");
@@ -784,9 +2497,11 @@ int main(int argc, char* argv[]) {
     }
 
     freeWeb(web,numOrgs); // Frees the memory that was allocated for the web and prey to avoid leaks
+    freeReportState(&lastReport);
 
 
 
     return 0;
 }
 
+#endif
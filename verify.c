@@ -0,0 +1,1125 @@
+/*-----------------------------------------------
+Program: Food Web Analyzer verification
+    Checks the web functions in main.c against reference copies of
+    them as first written. Seeded random operations are run on the
+    reference, on the current functions, on packed prey lists (-c)
+    and through stream mode's analyses (-e). Every printed result
+    must match, and the current functions must not be more than
+    VERIFY_MAX_SLOWDOWN times slower than the reference.
+    Exits 1 on any failure so a build can gate on it.
+
+Build: gcc -std=c99 -O2 -pthread -o foodweb_verify verify.c
+-------------------------------------------------*/
+
+
+#define FOODWEB_NO_MAIN // Only the functions from main.c, not its main
+#include "main.c"
+
+#include <signal.h>
+#include <time.h>
+
+/*
+Reference model: the web functions as they were first written.
+*/
+
+/*
+Function: refAddOrgToWeb
+Purpose:
+    Reference copy of addOrgToWeb as first written, for verify mode.
+    Keep it unchanged; the current addOrgToWeb is checked against it.
+Parameters, Returns:
+    same as addOrgToWeb
+*/
+void refAddOrgToWeb(Org** pWeb, int* pNumOrgs, char* newOrgName) {
+    
+    int oldSize = *pNumOrgs;
+    int newSize = oldSize + 1;
+
+    Org* newArray = (Org*)malloc(newSize* sizeof(Org));
+
+    for (int i = 0; i < oldSize; i++) {
+        newArray[i] = (*pWeb)[i];
+    }
+    strcpy(newArray[oldSize].name, newOrgName);
+    newArray[oldSize].prey = NULL;
+    newArray[oldSize].numPrey = 0;
+    newArray[oldSize].packed = NULL; // Only so freeWeb can free reference webs
+
+    if (*pWeb != NULL) {
+        free(*pWeb);
+    }
+    *pWeb = newArray;
+    *pNumOrgs = newSize;
+}
+
+/*
+Function: refAddRelationToWeb
+Purpose:
+    Reference copy of addRelationToWeb as first written, for verify mode.
+    Keep it unchanged; the current addRelationToWeb is checked against it.
+Parameters, Returns:
+    same as addRelationToWeb
+*/
+bool refAddRelationToWeb(Org* web, int numOrgs, int predInd, int preyInd) {
+    if ((predInd < 0) || (predInd > numOrgs - 1) || (preyInd < 0) || (preyInd > numOrgs - 1) || (predInd == preyInd)) {
+        printf("Invalid predator and/or prey index. No relation added to the food web.\n");
+        return false;
+    }
+    
+    Org* pred = &web[predInd];
+
+    for (int i = 0; i < pred->numPrey; i++) {
+        if (pred->prey[i] == preyInd) {
+            printf("Duplicate predator/prey relation. No relation added to the food web.\n");
+            return false;
+        }
+    }
+
+    int n = pred->numPrey;
+    int* newArray = (int*)malloc((n+1)*sizeof(int));
+
+    for (int i = 0; i < n; i++) {
+        newArray[i] = pred->prey[i];
+    }
+    newArray[n] = preyInd;
+
+    if (pred->prey != NULL) {
+        free(pred->prey);
+    }
+
+    pred->prey = newArray;
+    pred->numPrey = n + 1;
+
+    return true;
+
+}
+
+/*
+Function: refRemoveOrgFromWeb
+Purpose:
+    Reference copy of removeOrgFromWeb as first written, for verify mode.
+    Keep it unchanged; the current removeOrgFromWeb is checked against it.
+Parameters, Returns:
+    same as removeOrgFromWeb
+*/
+bool refRemoveOrgFromWeb(Org** pWeb, int* pNumOrgs, int index) {
+
+    if (*pWeb == NULL || *pNumOrgs == 0) {
+        return false;
+    }
+
+    if (index < 0 || index >= *pNumOrgs) {
+        printf("Invalid extinction index. No organism removed from the food web.\n");
+        return false;
+    }
+
+    Org* web = *pWeb;
+    int n = *pNumOrgs;
+
+    if (n == 1) {
+        if (web[0].prey != NULL) {
+            free(web[0].prey);
+        }
+        free(web);
+        *pWeb = NULL;
+        *pNumOrgs = 0;
+        return true;
+    }
+
+    if (web[index].prey != NULL) {
+            free(web[index].prey);
+            web[index].prey = NULL;
+            web[index].numPrey = 0;
+        }
+    
+    Org* newWeb = (Org*)malloc(sizeof(Org) * (n-1));
+    if (newWeb == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < index; i++) {
+        newWeb[i] = web[i];
+    }
+    for (int i = index + 1; i < n; i++) {
+        newWeb[i - 1] = web[i];
+    }
+
+    free(web);
+
+    *pWeb = newWeb;
+    *pNumOrgs = n - 1;
+    web = *pWeb;
+    n = *pNumOrgs;
+
+    for (int i = 0; i < n; i++) {
+        int oldCount = web[i].numPrey;
+        int* oldArr = web[i].prey;
+
+        if (!oldCount || oldArr == NULL) {
+            continue;
+        }
+
+        bool extinct = false;
+        bool greater = false;
+
+        for (int j = 0; j < oldCount; j++) {
+            if (oldArr[j] == index) {
+                extinct = true;
+            }
+            else if (oldArr[j] > index) {
+                greater = true;
+            }
+        }
+
+        if (!extinct && greater) {
+            for (int j = 0; j < oldCount; j++){
+                if (oldArr[j] > index){
+                    --oldArr[j];
+                }
+            }
+            continue;
+        }
+
+        if (!extinct && !greater) {
+            continue;
+        }
+
+        int newCount;
+        if (extinct) {
+            newCount = oldCount - 1;
+        }
+        else {
+            newCount = oldCount;
+        }
+
+        if (newCount == 0) {
+            free(oldArr);
+            web[i].prey = NULL;
+            web[i].numPrey = 0;
+            continue;
+        }
+
+        int* newArr = (int*)malloc(sizeof(int)*newCount);
+        if (newArr == NULL) {
+            continue;
+        }
+
+        int c = 0;
+        for (int j = 0; j < oldCount; j++) {
+            int ind = oldArr[j];
+            if (ind == index) {
+                continue;
+            }
+            if (ind > index) {
+                ind -= 1;
+            }
+            newArr[c++] = ind;
+        }
+        free(oldArr);
+        web[i].prey = newArr;
+        web[i].numPrey = newCount;
+    }
+    return true;
+}
+
+/*
+Function: refPrintWeb
+Purpose:
+    Reference copy of printWeb as first written, for verify mode.
+    Keep it unchanged; the current printWeb is checked against it.
+Parameters, Returns:
+    same as printWeb
+*/
+void refPrintWeb(Org* web, int numOrgs) {
+    for (int i = 0; i < numOrgs; i++) {
+        printf("  (%d) %s", i, web[i].name);
+        if (web[i].numPrey > 0) {
+            printf(" eats ");
+            for (int j = 0; j < web[i].numPrey; j++) {
+                int preyInd = web[i].prey[j];
+                printf("%s", web[preyInd].name);
+                if (j < web[i].numPrey - 1) {
+                    printf(", ");
+                }
+            }
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
+/*
+Function: refEatenByCounts
+Purpose:
+    Reference copy of eatenByCounts as first written, for verify mode.
+    Keep it unchanged; the current eatenByCounts is checked against it.
+Parameters, Returns:
+    same as eatenByCounts
+*/
+int* refEatenByCounts(Org* web, int numOrgs) {
+
+    int* eatenBy = (int*)malloc(sizeof(int)*numOrgs);
+
+    for (int i = 0; i < numOrgs; i++) {
+        eatenBy[i] = 0;
+    }
+
+    for (int i = 0; i < numOrgs; i++) {
+        for (int j = 0; j < web[i].numPrey; j++) {
+            int preyInd = web[i].prey[j];
+            eatenBy[preyInd]++;
+        }
+    }
+    return eatenBy;
+}
+
+/*
+Function: refCalculateHeights
+Purpose:
+    Reference copy of calculateHeights as first written, for verify mode.
+    Keep it unchanged; the current calculateHeights is checked against it.
+Parameters, Returns:
+    same as calculateHeights
+*/
+int* refCalculateHeights(Org* web, int numOrgs) {
+    int* height = (int*)malloc(sizeof(int)*numOrgs);
+
+    for (int i = 0; i < numOrgs; i++) {
+        height[i] = 0;
+    }
+
+    int change = 1;
+    while (change) {
+        change = 0;
+        for (int i = 0; i < numOrgs; i++) {
+            int newHeight = 0;
+            if (web[i].numPrey > 0) {
+                int maxPreyHeight = 0;
+                for (int j = 0; j < web[i].numPrey; j++) {
+                    int preyInd = web[i].prey[j];
+                    if (height[preyInd] > maxPreyHeight) {
+                        maxPreyHeight = height[preyInd];
+                    }
+                }
+                newHeight = maxPreyHeight + 1;
+            }
+            if (newHeight != height[i]) {
+                height[i] = newHeight;
+                change = 1;
+            }
+        }
+    } 
+    return height;
+}
+
+/*
+Function: refPrintHeights
+Purpose:
+    Reference copy of printHeights as first written, for verify mode.
+    Keep it unchanged; the current printHeights is checked against it.
+Parameters, Returns:
+    same as printHeights
+*/
+void refPrintHeights(Org* web, int numOrgs, int* height) {
+    for (int i = 0; i < numOrgs; i++) {
+        printf("  %s: %d\n", web[i].name, height[i]);
+    }
+}
+
+/*
+Function: refPrintVoreTypes
+Purpose:
+    Reference copy of printVoreTypes as first written, for verify mode.
+    Keep it unchanged; the current printVoreTypes is checked against it.
+Parameters, Returns:
+    same as printVoreTypes
+*/
+void refPrintVoreTypes(Org* web, int numOrgs) {
+    int* producer = (int*)malloc(sizeof(int)*numOrgs);
+    for (int i = 0; i < numOrgs; i++) {
+        if (web[i].numPrey == 0) {
+            producer[i] = 1;
+        }
+        else {
+            producer[i] = 0;
+        }
+    }
+    printf("  Producers:\n");
+    for (int i = 0; i < numOrgs; i++) {
+        if (producer[i]) {
+            printf("    %s\n", web[i].name);
+        }
+    }
+
+    printf("  Herbivores:\n");
+    for (int i = 0; i < numOrgs; i++) {
+        if (producer[i]) {
+            continue;
+        }
+        int eatsP = 0, eatsNP = 0;
+        for (int j = 0; j < web[i].numPrey; j++) {
+            int preyInd = web[i].prey[j];
+            if (producer[preyInd]) {
+                eatsP = 1;
+            }
+            else {
+                eatsNP = 1;
+            }
+        }
+        if (eatsP && !eatsNP) {
+            printf("    %s\n", web[i].name);
+        }
+    }
+
+    printf("  Omnivores:\n"); 
+    for (int i = 0; i < numOrgs; i++) {
+        if (producer[i]) {
+            continue;
+        }
+        int eatsP = 0, eatsNP = 0;
+        for (int j = 0; j < web[i].numPrey; j++) {
+            int preyInd = web[i].prey[j];
+            if (producer[preyInd]) {
+                eatsP = 1;
+            }
+            else {
+                eatsNP = 1;
+            }
+        }
+        if (eatsP && eatsNP) {
+            printf("    %s\n", web[i].name);
+        }
+    }
+
+    printf("  Carnivores:\n");
+    for (int i = 0; i < numOrgs; i++) {
+        if (producer[i]) {
+            continue;
+        }
+        int eatsP = 0, eatsNP = 0;
+        for (int j = 0; j < web[i].numPrey; j++) {
+            int preyInd = web[i].prey[j];
+            if (producer[preyInd]) {
+                eatsP = 1;
+            }
+            else {
+                eatsNP = 1;
+            }
+        }
+        if (!eatsP && eatsNP) {
+            printf("    %s\n", web[i].name);
+        }
+    }
+    printf("\n");
+    free(producer);
+}
+
+/*
+Function: refDisplayAll
+Purpose:
+    Reference copy of displayAll as first written, for verify mode.
+    Keep it unchanged; the current displayAll is checked against it.
+Parameters, Returns:
+    same as displayAll
+*/
+void refDisplayAll(Org* web, int numOrgs, bool modified) {
+
+    if (modified) printf("UPDATED ");
+    printf("Food Web Predators & Prey:\n");
+    refPrintWeb(web,numOrgs); 
+
+    int* eatenBy = refEatenByCounts(web, numOrgs);
+
+    if (modified) printf("UPDATED ");
+    printf("Apex Predators:\n");
+    for (int i = 0; i < numOrgs; i++) {
+        if (eatenBy[i] == 0) {
+            printf("  %s\n", web[i].name);
+        }
+    }
+    printf("\n");
+
+    if (modified) printf("UPDATED ");
+    printf("Producers:\n");
+    for (int i = 0; i < numOrgs; i++) {
+        if (web[i].numPrey == 0) {
+            printf("  %s\n", web[i].name);
+        }
+    }
+    printf("\n");
+
+    if (modified) printf("UPDATED ");
+    printf("Most Flexible Eaters:\n");
+    int maxPrey = 0;
+    for (int i = 0; i < numOrgs; i++) {
+        if (web[i].numPrey > maxPrey) {
+            maxPrey = web[i].numPrey;
+        }
+    }
+    for (int i = 0; i < numOrgs; i++) {
+        if (web[i].numPrey == maxPrey) {
+            printf("  %s\n", web[i].name);
+        }
+    }
+    printf("\n");
+
+    if (modified) printf("UPDATED ");
+    printf("Tastiest Food:\n");
+    int maxEaten = 0;
+    for (int i = 0; i < numOrgs; i++) {
+        if (eatenBy[i] > maxEaten) {
+            maxEaten = eatenBy[i];
+        }
+    }
+    for (int i = 0; i < numOrgs; i++) {
+        if (eatenBy[i] == maxEaten) {
+            printf("  %s\n", web[i].name);
+        }
+    }
+    printf("\n");
+    free(eatenBy);
+
+    if (modified) printf("UPDATED ");
+    printf("Food Web Heights:\n");
+    int* heights = refCalculateHeights(web, numOrgs);
+    refPrintHeights(web, numOrgs, heights);
+    free(heights);
+    printf("\n");
+
+    if (modified) printf("UPDATED ");
+    printf("Vore Types:\n");
+    refPrintVoreTypes(web, numOrgs);
+}
+
+#define VERIFY_ROUNDS 20 // Seeds 1..VERIFY_ROUNDS are run by verify mode
+#define VERIFY_OPS 4000 // Operations per round
+#define VERIFY_MAX_SLOWDOWN 1.5 // Fail if the plain engine takes longer than this times the reference for any operation
+#define VERIFY_RUN_EDGES 16 // Relations per sorted run when the stream engine writes its relation file
+#define VERIFY_ROUND_SECONDS 120 // A round running longer is taken to be stuck, e.g. heights looping on a cycle
+
+static char verifyTimeoutMessage[120]; // What verifyTimeout prints, set before each round
+static int verifyTimeoutFd = -1; // The real stdout while a round's output is captured
+
+/*
+Struct: VerifyOp
+Purpose:
+    One randomly drawn step of a verify round. The raw numbers are
+    turned into indices by each run against its own web, so the
+    reference and the engine see the same steps as long as they agree.
+Fields:
+    kind - which operation, 0-99 (see runVerifyOps)
+    x, y - raw random numbers for the indices
+*/
+typedef struct VerifyOp_struct {
+    unsigned int kind;
+    unsigned int x;
+    unsigned int y;
+} VerifyOp;
+
+/*
+Function: verifyRand
+Purpose:
+    xorshift32, so a seed gives the same steps on every platform
+Parameters:
+    pState - generator state, never 0
+Returns:
+    next random number
+*/
+unsigned int verifyRand(unsigned int* pState) {
+    unsigned int x = *pState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pState = x;
+    return x;
+}
+
+/*
+Function: printSortedPrey
+Purpose:
+    Print every organism's prey in index order, so webs whose prey
+    lists hold the same prey in a different order print the same
+Parameters:
+    web, numOrgs
+Returns:
+    void
+*/
+void printSortedPrey(Org* web, int numOrgs) {
+    int* prey = (int*)malloc(sizeof(int) * (numOrgs + 1));
+    for (int i = 0; i < numOrgs; i++) {
+        PreyIter it;
+        int n = 0;
+        preyIterStart(&it, &web[i]);
+        while (preyIterNext(&it, &prey[n])) {
+            n++;
+        }
+        qsort(prey, n, sizeof(int), compareInts);
+        printf("  [%d]", i);
+        for (int j = 0; j < n; j++) {
+            printf(" %d", prey[j]);
+        }
+        printf("\n");
+    }
+    free(prey);
+}
+
+/*
+Function: verifyNow
+Purpose:
+    Monotonic clock reading
+Parameters:
+    none
+Returns:
+    seconds
+*/
+double verifyNow() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+enum { VERIFY_ADD_ORG, VERIFY_ADD_REL, VERIFY_EXTINCT, VERIFY_HEIGHTS, VERIFY_VORES, VERIFY_REPORT, VERIFY_KINDS }; // Operation kinds timed by verify mode
+
+/*
+Struct: WebEdgeSource
+Purpose:
+    sortEdges source that walks a web's relations twice, so every
+    relation also comes in once more as a repeat to be dropped
+Fields:
+    web, numOrgs - web walked
+    pass - 0 on the first walk, 1 on the second
+    org - organism whose prey are being walked
+    it - iterator over that organism's prey
+*/
+typedef struct WebEdgeSource_struct {
+    Org* web;
+    int numOrgs;
+    int pass;
+    int org;
+    PreyIter it;
+} WebEdgeSource;
+
+/*
+Function: nextWebEdge
+Purpose:
+    nextEdge callback for a WebEdgeSource
+Parameters:
+    source - the WebEdgeSource
+    e - receives the relation
+Returns:
+    true if a relation was stored, false after the second walk
+*/
+bool nextWebEdge(void* source, Edge* e) {
+    WebEdgeSource* src = (WebEdgeSource*)source;
+    while (src->pass < 2) {
+        if (src->org < src->numOrgs && preyIterNext(&src->it, &e->prey)) {
+            e->pred = src->org;
+            return true;
+        }
+        src->org++;
+        if (src->org >= src->numOrgs) {
+            src->org = 0;
+            src->pass++;
+        }
+        if (src->pass < 2 && src->numOrgs > 0) {
+            preyIterStart(&src->it, &src->web[src->org]);
+        }
+    }
+    return false;
+}
+
+/*
+Function: writeEdgeFile
+Purpose:
+    Store a web's relations with sortEdges, as stream mode does, in
+    runs of VERIFY_RUN_EDGES so several levels of merging happen.
+    Every relation is fed twice; if sortEdges does not drop exactly
+    one repeat per relation that is printed to the transcript.
+Parameters:
+    web, numOrgs
+Returns:
+    the sorted relation file rewound for reading, or NULL if a
+    temporary file could not be created or written
+*/
+FILE* writeEdgeFile(Org* web, int numOrgs) {
+
+    WebEdgeSource src;
+    src.web = web;
+    src.numOrgs = numOrgs;
+    src.pass = 0;
+    src.org = 0;
+    if (numOrgs > 0) {
+        preyIterStart(&src.it, &web[0]);
+    }
+
+    long duplicates = 0;
+    FILE* edges = sortEdges(nextWebEdge, &src, VERIFY_RUN_EDGES, &duplicates);
+
+    long numRelations = 0;
+    for (int i = 0; i < numOrgs; i++) {
+        numRelations += web[i].numPrey;
+    }
+    if (edges != NULL && duplicates != numRelations) {
+        printf("relation file dropped %ld repeats, expected %ld\n", duplicates, numRelations);
+    }
+    return edges;
+}
+
+/*
+Function: runVerifyOps
+Purpose:
+    Apply one round of steps to a fresh web and print a transcript of
+    every result to stdout. Relations always point from a higher to a
+    lower index, so the web never has a cycle (heights would not
+    converge), but invalid pairs, self-relations, repeats and invalid
+    extinction indices are all drawn on purpose.
+Parameters:
+    ops - the steps
+    numOps - number of steps
+    engine - 0 = reference functions, 1 = current functions,
+             2 = current functions with packed prey lists (-c),
+             3 = current functions, with heights, vore types and
+                 reports computed by stream mode (-e) from a relation file
+    seconds - time spent per operation kind, added to
+Returns:
+    void
+*/
+void runVerifyOps(VerifyOp* ops, int numOps, int engine, double* seconds) {
+
+    Org* web = NULL;
+    int numOrgs = 0;
+    int nextName = 0;
+
+    for (int k = 0; k < numOps; k++) {
+        VerifyOp op = ops[k];
+        int n = numOrgs;
+        int kind;
+
+        if (n < 2 || op.kind % 100 < 12) { // Twice as many additions as extinctions, so the web keeps growing
+            kind = VERIFY_ADD_ORG;
+        } else if (op.kind % 100 < 70) {
+            kind = VERIFY_ADD_REL;
+        } else if (op.kind % 100 < 76) {
+            kind = VERIFY_EXTINCT;
+        } else if (op.kind % 100 < 86) {
+            kind = VERIFY_HEIGHTS;
+        } else if (op.kind % 100 < 95) {
+            kind = VERIFY_VORES;
+        } else {
+            kind = VERIFY_REPORT;
+        }
+
+        printf("#%d\n", k);
+        double start = verifyNow();
+
+        if (kind == VERIFY_ADD_ORG) {
+            char name[20];
+            sprintf(name, "org%d", nextName++);
+            if (engine == 0) {
+                refAddOrgToWeb(&web, &numOrgs, name);
+            } else {
+                addOrgToWeb(&web, &numOrgs, name);
+            }
+
+        } else if (kind == VERIFY_ADD_REL) {
+            int predInd, preyInd;
+            if (op.x % 10 == 0) { // Invalid pair: out of range on either side, or a self-relation
+                int bad[] = { -1, n, (int)(op.y % n) };
+                predInd = bad[op.y % 3];
+                preyInd = (op.y % 3 == 2) ? predInd : (int)(op.x / 10 % n);
+                if (op.y & 8) {
+                    int t = predInd;
+                    predInd = preyInd;
+                    preyInd = t;
+                }
+            } else {
+                int a = op.x % n;
+                int b = op.y % (n - 1);
+                if (b >= a) {
+                    b++;
+                }
+                predInd = (a > b) ? a : b;
+                preyInd = (a > b) ? b : a;
+            }
+            bool added;
+            if (engine == 0) {
+                added = refAddRelationToWeb(web, numOrgs, predInd, preyInd);
+            } else {
+                added = addRelationToWeb(web, numOrgs, predInd, preyInd, stdout);
+            }
+            if (added && engine == 2) { // As -c does
+                packOrg(&web[predInd]);
+            }
+            printf("relation %d %d -> %d\n", predInd, preyInd, added);
+
+        } else if (kind == VERIFY_EXTINCT) {
+            int index = (int)(op.x % (n + 2)) - 1; // -1 and n are invalid
+            bool removed;
+            if (engine == 0) {
+                removed = refRemoveOrgFromWeb(&web, &numOrgs, index);
+            } else {
+                removed = removeOrgFromWeb(&web, &numOrgs, index);
+            }
+            printf("extinct %d -> %d\n", index, removed);
+
+        } else if (kind == VERIFY_HEIGHTS) {
+            int* heights = NULL;
+            if (engine == 0) {
+                heights = refCalculateHeights(web, numOrgs);
+            } else if (engine == 3) {
+                FILE* edges = writeEdgeFile(web, numOrgs);
+                if (edges != NULL) {
+                    heights = streamHeights(numOrgs, edges);
+                    fclose(edges);
+                }
+            } else {
+                heights = calculateHeights(web, numOrgs);
+            }
+            if (heights != NULL) {
+                printHeights(web, numOrgs, heights, stdout);
+                free(heights);
+            } else {
+                printf("relation file could not be written\n");
+            }
+
+        } else if (kind == VERIFY_VORES) {
+            if (engine == 0) {
+                refPrintVoreTypes(web, numOrgs);
+            } else if (engine == 3) {
+                FILE* edges = writeEdgeFile(web, numOrgs);
+                if (edges != NULL) {
+                    int* vore = streamVores(web, numOrgs, edges);
+                    printVoreClasses(web, numOrgs, vore, stdout);
+                    free(vore);
+                    fclose(edges);
+                } else {
+                    printf("relation file could not be written\n");
+                }
+            } else {
+                printVoreTypes(web, numOrgs, stdout);
+            }
+
+        } else {
+            if (engine == 0) {
+                refDisplayAll(web, numOrgs, false);
+            } else if (engine == 3) {
+                Org* names = (Org*)malloc(sizeof(Org) * (numOrgs + 1)); // Names only, as runStream builds them
+                for (int i = 0; i < numOrgs; i++) {
+                    names[i] = web[i];
+                    names[i].prey = NULL;
+                    names[i].numPrey = 0;
+                    names[i].lastPrey = 0;
+                    names[i].packed = NULL;
+                }
+                FILE* edges = writeEdgeFile(web, numOrgs);
+                if (edges != NULL) {
+                    printStreamReport(names, numOrgs, edges, stdout);
+                    fclose(edges);
+                } else {
+                    printf("relation file could not be written\n");
+                }
+                free(names);
+            } else {
+                displayAll(web, numOrgs, false, stdout);
+            }
+        }
+
+        seconds[kind] += verifyNow() - start;
+
+        if (kind == VERIFY_REPORT || k == numOps - 1) {
+            printSortedPrey(web, numOrgs);
+        }
+    }
+
+    freeWeb(web, numOrgs);
+}
+
+/*
+Function: verifyTimeout
+Purpose:
+    SIGALRM handler for a round that did not finish in
+    VERIFY_ROUND_SECONDS: fail the whole run, naming the engine and
+    seed, instead of hanging the build
+Parameters:
+    sig - unused
+Returns:
+    does not return
+*/
+void verifyTimeout(int sig) {
+    (void)sig;
+    ssize_t written = write(verifyTimeoutFd, verifyTimeoutMessage, strlen(verifyTimeoutMessage));
+    (void)written; // Failing is all that is left to do either way
+    _exit(1);
+}
+
+/*
+Function: captureVerifyOps
+Purpose:
+    Run one round with stdout sent to a temporary file, so the
+    messages printed by the functions under test land in the
+    transcript too. The round is stopped by verifyTimeout if it takes
+    longer than VERIFY_ROUND_SECONDS.
+Parameters:
+    ops, numOps, engine, seconds - as for runVerifyOps
+    seed - seed of the round, for the timeout message
+Returns:
+    the transcript as a heap string, caller frees it; NULL if no
+    temporary file could be created
+*/
+char* captureVerifyOps(VerifyOp* ops, int numOps, int engine, unsigned int seed, double* seconds) {
+
+    char* engineNames[] = { "reference", "plain", "packed", "stream" };
+
+    FILE* capture = tmpfile();
+    if (capture == NULL) {
+        return NULL;
+    }
+
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    dup2(fileno(capture), STDOUT_FILENO);
+
+    snprintf(verifyTimeoutMessage, sizeof(verifyTimeoutMessage),
+             "  %s engine did not finish seed %u in %d seconds\nVerification FAILED\n",
+             engineNames[engine], seed, VERIFY_ROUND_SECONDS);
+    verifyTimeoutFd = savedStdout;
+    signal(SIGALRM, verifyTimeout);
+    alarm(VERIFY_ROUND_SECONDS);
+
+    runVerifyOps(ops, numOps, engine, seconds);
+
+    alarm(0);
+    fflush(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+
+    fseek(capture, 0, SEEK_END);
+    long len = ftell(capture);
+    rewind(capture);
+
+    char* text = (char*)malloc(len + 1);
+    len = (long)fread(text, 1, len, capture);
+    text[len] = '\0';
+    fclose(capture);
+    return text;
+}
+
+/*
+Function: compareStrings
+Purpose:
+    qsort comparator for an array of C strings
+Parameters:
+    a, b - pointers to char*
+Returns:
+    negative, zero or positive as for qsort
+*/
+int compareStrings(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/*
+Function: sortWebListings
+Purpose:
+    Sort the prey names on each printWeb line ("  (i) name eats a, b")
+    of a transcript in place. Packed prey lists and stream mode print
+    prey in index order, so only the prey sets can be compared.
+Parameters:
+    text - transcript
+Returns:
+    void
+*/
+void sortWebListings(char* text) {
+    char* line = text;
+    while (*line != '\0') {
+        size_t len = strcspn(line, "\n");
+        char end = line[len];
+        line[len] = '\0'; // So strstr stays on this line
+        char* eats = strstr(line, " eats ");
+        line[len] = end;
+        if (strncmp(line, "  (", 3) == 0 && eats != NULL) {
+            char* list = eats + 6;
+            size_t listLen = (size_t)(line + len - list);
+            char* copy = (char*)malloc(listLen + 1);
+            memcpy(copy, list, listLen);
+            copy[listLen] = '\0';
+
+            char** names = (char**)malloc(sizeof(char*) * (listLen / 2 + 1));
+            int n = 0;
+            for (char* name = strtok(copy, ", "); name != NULL; name = strtok(NULL, ", ")) {
+                names[n++] = name;
+            }
+            qsort(names, n, sizeof(char*), compareStrings);
+
+            char* dst = list; // Same names and separators, so the line keeps its length
+            for (int j = 0; j < n; j++) {
+                if (j > 0) {
+                    *dst++ = ',';
+                    *dst++ = ' ';
+                }
+                size_t nameLen = strlen(names[j]);
+                memcpy(dst, names[j], nameLen);
+                dst += nameLen;
+            }
+            free(names);
+            free(copy);
+        }
+        line += len;
+        if (*line == '\n') {
+            line++;
+        }
+    }
+}
+
+/*
+Function: reportMismatch
+Purpose:
+    Print where two transcripts first differ
+Parameters:
+    label - which engine, seed, ref, got - transcripts
+Returns:
+    void
+*/
+void reportMismatch(char* label, unsigned int seed, char* ref, char* got) {
+    size_t i = 0;
+    while (ref[i] != '\0' && ref[i] == got[i]) {
+        i++;
+    }
+    size_t lineStart = i;
+    while (lineStart > 0 && ref[lineStart - 1] != '\n') {
+        lineStart--;
+    }
+    size_t step = lineStart; // Last "#k" step marker before the difference
+    while (step > 0 && !(ref[step] == '#' && ref[step - 1] == '\n')) {
+        step--;
+    }
+    printf("  %s engine MISMATCH for seed %u at step %.*s\n", label, seed, (int)strcspn(ref + step, "\n"), ref + step);
+    printf("    reference: %.*s\n", (int)strcspn(ref + lineStart, "\n"), ref + lineStart);
+    printf("    engine:    %.*s\n", (int)strcspn(got + lineStart, "\n"), got + lineStart);
+}
+
+/*
+Function: compareDoubles
+Purpose:
+    qsort comparator for ascending doubles
+Parameters:
+    a, b - pointers to double
+Returns:
+    negative, zero or positive as for qsort
+*/
+int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/*
+Function: runVerify
+Purpose:
+    Drives the reference functions, the current functions, the
+    current functions with packed prey lists, and stream mode's
+    heights, vore types and reports through the same seeded random
+    steps, and checks that all four print the same transcript (packed
+    webs and stream mode may list prey in another order). A round
+    that does not finish in VERIFY_ROUND_SECONDS fails the run. Then
+    prints the time each operation took relative to the reference
+    (median over the seeds, so one noisy round does not decide it),
+    and fails if the plain engine is more than VERIFY_MAX_SLOWDOWN
+    times slower on any of them.
+Parameters:
+    none
+Returns:
+    true if everything matched and no operation was too slow
+*/
+bool runVerify() {
+
+    char* kindNames[] = { "add organism", "add relation", "extinction", "heights", "vore types", "full report" };
+    double ratios[3][VERIFY_KINDS][VERIFY_ROUNDS]; // [plain/packed/stream][kind][seed], time over reference time
+
+    VerifyOp* ops = (VerifyOp*)malloc(sizeof(VerifyOp) * VERIFY_OPS);
+    bool passed = true;
+
+    printf("Verifying against the reference implementation (%d seeds, %d operations each)...\n", VERIFY_ROUNDS, VERIFY_OPS);
+
+    for (unsigned int seed = 1; seed <= VERIFY_ROUNDS; seed++) {
+        unsigned int state = seed * 2654435761u;
+        for (int k = 0; k < VERIFY_OPS; k++) {
+            ops[k].kind = verifyRand(&state);
+            ops[k].x = verifyRand(&state);
+            ops[k].y = verifyRand(&state);
+        }
+
+        double seconds[4][VERIFY_KINDS];
+        for (int e = 0; e < 4; e++) {
+            for (int k = 0; k < VERIFY_KINDS; k++) {
+                seconds[e][k] = 0;
+            }
+        }
+
+        char* ref = captureVerifyOps(ops, VERIFY_OPS, 0, seed, seconds[0]);
+        char* plain = captureVerifyOps(ops, VERIFY_OPS, 1, seed, seconds[1]);
+        char* packed = captureVerifyOps(ops, VERIFY_OPS, 2, seed, seconds[2]);
+        char* stream = captureVerifyOps(ops, VERIFY_OPS, 3, seed, seconds[3]);
+        for (int e = 0; e < 3; e++) {
+            for (int k = 0; k < VERIFY_KINDS; k++) {
+                ratios[e][k][seed - 1] = seconds[e + 1][k] / seconds[0][k];
+            }
+        }
+        if (ref == NULL || plain == NULL || packed == NULL || stream == NULL) {
+            printf("  Could not create a temporary file.\n");
+            passed = false;
+        }
+        else {
+            if (strcmp(ref, plain) != 0) {
+                reportMismatch("plain", seed, ref, plain);
+                passed = false;
+            }
+            sortWebListings(ref);
+            sortWebListings(packed);
+            sortWebListings(stream);
+            if (strcmp(ref, packed) != 0) {
+                reportMismatch("packed", seed, ref, packed);
+                passed = false;
+            }
+            if (strcmp(ref, stream) != 0) {
+                reportMismatch("stream", seed, ref, stream);
+                passed = false;
+            }
+        }
+        free(ref);
+        free(plain);
+        free(packed);
+        free(stream);
+    }
+    free(ops);
+
+    printf("\nMedian time relative to the reference (plain, packed, stream):\n");
+    for (int k = 0; k < VERIFY_KINDS; k++) {
+        for (int e = 0; e < 3; e++) {
+            qsort(ratios[e][k], VERIFY_ROUNDS, sizeof(double), compareDoubles);
+        }
+        double plainRatio = ratios[0][k][VERIFY_ROUNDS / 2];
+        bool slow = (plainRatio > VERIFY_MAX_SLOWDOWN); // Packed and stream trade speed for memory, they are only reported
+        printf("  %s: %.2fx, %.2fx, %.2fx%s\n", kindNames[k], plainRatio,
+               ratios[1][k][VERIFY_ROUNDS / 2], ratios[2][k][VERIFY_ROUNDS / 2], slow ? "  TOO SLOW" : "");
+        if (slow) {
+            passed = false;
+        }
+    }
+    printf("\n");
+
+    printf("Verification %s\n", passed ? "PASSED" : "FAILED");
+    return passed;
+}
+
+/*
+Function: main
+Purpose:
+    Run the verification
+Parameters:
+    none
+Returns:
+    0 if it passed, 1 if it failed
+*/
+int main() {
+    return runVerify() ? 0 : 1;
+}